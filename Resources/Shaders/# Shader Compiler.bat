@@ -1,3 +1,4 @@
 @echo off
 C:/VulkanSDK/1.1.126.0/Bin32/glslangValidator.exe -V "%~nx1" -o "%~n1.spv"
+"%~dp0../../build/x64/Release/voxceleron2-tools.exe" pack "%~dp0../Resources.pack" "%~dp0.." .spv .array
 pause
\ No newline at end of file
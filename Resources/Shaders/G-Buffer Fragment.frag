@@ -8,6 +8,7 @@ layout(location = 0) in vec3 fragment_position;
 layout(location = 1) in vec2 fragment_uv;
 layout(location = 2) in vec3 fragment_normal;
 layout(location = 3) flat in float fragment_material;
+layout(location = 4) in float fragment_occlusion;
 
 layout(location = 0) out vec4 position_out;
 layout(location = 1) out vec4 normal_out;
@@ -17,7 +18,7 @@ layout(location = 3) out float specular_out;
 void main()
 {
 	position_out = vec4(fragment_position, 1);
-	normal_out = vec4(fragment_normal*.5f+.5f, 1);
+	normal_out = vec4(fragment_normal*.5f+.5f, fragment_occlusion);
 	albedo_out = vec4(texture(texture_map_sampler,
 		  vec3(fragment_uv, (fragment_material-1)*2)).rgb, 1);
 	specular_out = texture(texture_map_sampler,
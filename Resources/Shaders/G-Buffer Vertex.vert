@@ -8,11 +8,13 @@ layout(location = 0) in vec3 vertex_position;
 layout(location = 1) in vec2 vertex_uv;
 layout(location = 2) in vec3 vertex_normal;
 layout(location = 3) in float vertex_material;
+layout(location = 4) in float vertex_occlusion;
 
 layout(location = 0) out vec3 fragment_position;
 layout(location = 1) out vec2 fragment_uv;
 layout(location = 2) out vec3 fragment_normal;
 layout(location = 3) out float fragment_material;
+layout(location = 4) out float fragment_occlusion;
 
 out gl_PerVertex{ vec4 gl_Position; };
 
@@ -28,4 +30,6 @@ void main()
 	fragment_normal = NORMAL_MATRIX*vertex_normal;
 
 	fragment_material = vertex_material;
+
+	fragment_occlusion = vertex_occlusion;
 }
\ No newline at end of file
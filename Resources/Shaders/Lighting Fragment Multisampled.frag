@@ -16,6 +16,7 @@ Uniforms
 	mat4 inverse_view;
 	mat4 transposed_view;
 	mat4 shadow_matrix;
+	uint screen_space_ambient_occlusion;
 } uniforms;
 
 layout(location = 0) in vec2 in_uv;
@@ -69,14 +70,16 @@ void main()
 	//Textures
 	const vec3 POSITION = vec4(uniforms.inverse_view*vec4(
 		textureMS(position_sampler, in_uv).xyz, 1.f)).xyz;
+	const vec4 NORMAL_SAMPLE = textureMS(normal_sampler, in_uv);
 	const vec3 NORMAL = normalize(mat3(uniforms.transposed_view)*
-		(textureMS(normal_sampler, in_uv).xyz*2.f-1.f));
+		(NORMAL_SAMPLE.xyz*2.f-1.f));
 	const vec3 ALBEDO = textureMS(albedo_sampler, in_uv).rgb;
 	const float ROUGHNESS = .999f;
 	const float ROUGHNESS_SQUARED = .998001f;
 	const float ROUGHNESS_PLUS_ONE_SQUARED_DIVIDED_BY_8 = .499500125f;
 	const vec4 TRANSLUCENT = textureMS(translucent_sampler, in_uv);
-	const float OCCLUSION = texture(ssao_sampler, in_uv).r;
+	const float OCCLUSION = mix(.35f, 1.f, NORMAL_SAMPLE.a)*
+		(uniforms.screen_space_ambient_occlusion != 0 ? texture(ssao_sampler, in_uv).r : 1.f);
 	const float METALLIC = 0.f;
 	const vec3 F0 = mix(vec3(.04f), ALBEDO, METALLIC);
 
@@ -0,0 +1,5 @@
+@echo off
+cd /d "%~dp0"
+"../../build/x64/Release/voxceleron2-tools.exe" textures "Textures.array" linear "Stone.png" "Dirt Specular.png" "Dirt.png" "Dirt Specular.png" "Grass.png" "Dirt Specular.png" "Sand.png" "Dirt Specular.png" "Wood.png" "Dirt Specular.png" "Leaves.png" "Dirt Specular.png"
+"../../build/x64/Release/voxceleron2-tools.exe" pack "../Resources.pack" ".." .spv .array
+pause
@@ -0,0 +1,43 @@
+#include <algorithm>
+#include <functional>
+#include "Common.hpp"
+#include "Chunk Queue.hpp"
+
+void Tetra::Chunk_Queue::push(const glm::ivec3& chunk_position)
+{
+	if(!queued.insert(chunk_position).second) return;
+	heap.push_back({get_priority(chunk_position), chunk_position});
+	std::push_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+}
+
+bool Tetra::Chunk_Queue::pop(glm::ivec3 *chunk_position)
+{
+	if(heap.empty()) return false;
+	std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+	*chunk_position = heap.back().chunk_position;
+	heap.pop_back();
+	queued.erase(*chunk_position);
+	return true;
+}
+
+void Tetra::Chunk_Queue::set_view(const glm::fvec3& camera_position,
+	const glm::fvec3& camera_direction)
+{
+	this->camera_position = camera_position;
+	this->camera_direction = camera_direction;
+
+	//Rekey every entry, this only happens when the view changed enough to matter
+	for(Entry& e : heap) e.priority = get_priority(e.chunk_position);
+	std::make_heap(heap.begin(), heap.end(), std::greater<Entry>{});
+}
+
+float Tetra::Chunk_Queue::get_priority(const glm::ivec3& chunk_position) const
+{
+	const glm::fvec3 OFFSET{glm::fvec3(chunk_position)*static_cast<float>(CHUNK_SIZE)+
+		glm::fvec3(CHUNK_SIZE/2)-camera_position};
+	const float DISTANCE{glm::length(OFFSET)};
+	if(DISTANCE < CHUNK_SIZE) return DISTANCE;
+
+	//Straight ahead keeps its distance, straight behind counts as twice as far
+	return DISTANCE*(1.f+VIEW_WEIGHT*(1.f-glm::dot(OFFSET/DISTANCE, camera_direction)));
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <unordered_set>
+#include "Common.hpp"
+
+namespace Tetra
+{
+	//A min heap of chunk positions ordered by distance to the camera, weighted up for chunks
+	//away from the view direction. A chunk is queued at most once, pushing it again while
+	//queued does nothing. Entries are not removed when a chunk changes, the owner
+	//validates them as they are popped.
+	class Chunk_Queue
+	{
+	public:
+		void push(const glm::ivec3& chunk_position);
+		bool pop(glm::ivec3 *chunk_position);
+		void clear(){ heap.clear(), queued.clear(); }
+		void set_view(const glm::fvec3& camera_position, const glm::fvec3& camera_direction);
+
+		bool empty() const { return heap.empty(); }
+		size_t size() const { return heap.size(); }
+		const glm::fvec3& get_view_position() const { return camera_position; }
+		const glm::fvec3& get_view_direction() const { return camera_direction; }
+
+	private:
+		static constexpr float VIEW_WEIGHT{.5f};
+
+		struct Entry
+		{
+			float priority;
+			glm::ivec3 chunk_position;
+
+			bool operator>(const Entry& other) const { return priority > other.priority; }
+		};
+
+		std::vector<Entry> heap;
+		std::unordered_set<glm::ivec3, ivec3_hash> queued;
+		glm::fvec3 camera_position, camera_direction{0, 0, 1};
+
+		float get_priority(const glm::ivec3& chunk_position) const;
+	};
+}
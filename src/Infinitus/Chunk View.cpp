@@ -0,0 +1,57 @@
+#include <algorithm>
+#include "Chunk View.hpp"
+
+Tetra::Chunk_View::Chunk_View(const uint8_t *data, size_t size)
+	: data(data), palette(data+1), size(size), start(), palette_size(), index_bits(), valid()
+{
+	if(!size || size < 2U+data[0]) return;
+	palette_size = data[0]+1U;
+	for(uint8_t i{}; i < palette_size; ++i) if(palette[i] > WATER) return;
+	while((1U<<index_bits) < palette_size) ++index_bits;
+	start = 1+palette_size;
+
+	//Every run is checked once, so later reads can trust the data
+	size_t position{start};
+	uint32_t count, runs{};
+	uint8_t material;
+	for(uint32_t first{}; first < CHUNK_SIZE_CUBED; first += count, ++runs)
+	{
+		if(!(runs%CHECKPOINT_RUNS))
+			checkpoints.push_back({first, static_cast<uint32_t>(position)});
+		if(!read_run(&position, &count, &material) || count > CHUNK_SIZE_CUBED-first) return;
+	}
+	valid = position == size;
+}
+
+uint8_t Tetra::Chunk_View::get_voxel_material(const glm::u8vec3& voxel) const
+{
+	if(!valid) return 0;
+	const uint32_t INDEX{static_cast<uint32_t>((voxel.z*CHUNK_SIZE+voxel.y)*CHUNK_SIZE+voxel.x)};
+	const Checkpoint& CHECKPOINT{*(std::upper_bound(checkpoints.begin(), checkpoints.end(),
+		INDEX, [](uint32_t i, const Checkpoint& c){ return i < c.voxel; })-1)};
+
+	size_t position{CHECKPOINT.position};
+	uint32_t count;
+	uint8_t material;
+	for(uint32_t first{CHECKPOINT.voxel};; first += count)
+	{
+		read_run(&position, &count, &material);
+		if(INDEX < first+count) return material;
+	}
+}
+
+bool Tetra::Chunk_View::read_run(size_t *position, uint32_t *count, uint8_t *material) const
+{
+	uint64_t token{};
+	for(uint8_t shift{};; shift += 7)
+	{
+		if(*position == size || shift > 56) return false;
+		token |= static_cast<uint64_t>(data[*position]&0x7F)<<shift;
+		if(!(data[(*position)++]&0x80)) break;
+	}
+	const uint32_t INDEX{static_cast<uint32_t>(token&((1U<<index_bits)-1))};
+	const uint64_t RUN{(token>>index_bits)+1};
+	if(INDEX >= palette_size || RUN > CHUNK_SIZE_CUBED) return false;
+	*count = static_cast<uint32_t>(RUN), *material = palette[INDEX];
+	return true;
+}
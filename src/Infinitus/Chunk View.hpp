@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include "Chunk.hpp"
+
+namespace Tetra
+{
+	//Read only access to a chunk as encoded by Chunk::encode, in place in storage such as
+	//a mapped region file, which has to outlive the view. It has the voxel accessors of
+	//Chunk, so code templated on them runs on either without decoding a dense chunk. The
+	//game only uses views to validate and decode stored chunks into dense ones, so they
+	//save it no memory, meshing from them is done by the tools.
+	//Random access decodes forward from the nearest of a sparse set of checkpoints, whole
+	//chunks are best read in order with for_each_run.
+	class Chunk_View
+	{
+	public:
+		Chunk_View(const uint8_t *data, size_t size);
+
+		bool is_valid() const { return valid; }
+		uint8_t get_voxel_material(const glm::u8vec3& voxel) const;
+		bool is_voxel_transparent(const glm::u8vec3& voxel) const
+		{ return Chunk::is_material_transparent(get_voxel_material(voxel)); }
+
+		//Calls run(first, count, material) for each run of one material in voxel order
+		template<typename Run> void for_each_run(Run&& run) const
+		{
+			if(!valid) return;
+			size_t position{start};
+			uint32_t count;
+			uint8_t material;
+			for(uint32_t first{}; first < CHUNK_SIZE_CUBED; first += count)
+				read_run(&position, &count, &material), run(first, count, material);
+		}
+
+	private:
+		static constexpr uint32_t CHECKPOINT_RUNS{32};
+
+		//Where a run starts, as a voxel index and a position in the data
+		struct Checkpoint{ uint32_t voxel, position; };
+
+		const uint8_t *data, *palette;
+		size_t size, start;
+		uint8_t palette_size, index_bits;
+		bool valid;
+		std::vector<Checkpoint> checkpoints;
+
+		bool read_run(size_t *position, uint32_t *count, uint8_t *material) const;
+	};
+}
@@ -1,22 +1,162 @@
-#include "Chunk.hpp"
+#include <algorithm>
+#include <cstring>
+#include "Chunk View.hpp"
 
 Tetra::Chunk::Chunk(const glm::fvec3& translation, const glm::fvec3& world_translation,
-	const glm::u8vec3& index) : translation(translation), 
-	world_translation(world_translation), index(index){}
+	const glm::u8vec3& index) : culled(), uploaded(), stored(), materials_hashed(),
+	materials_hash(), generated(), state(ALLOCATED), translation(translation), 
+	world_translation(world_translation), index(index), lod(), skirts(), population_lod(),
+	edit_revision(){}
 
-void Tetra::Chunk::greedy_face(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas,
-	uint8_t material, uint32_t *face, uint8_t axis, uint8_t sign,
-	const glm::fvec3& position, const glm::fvec2& size)
+bool Tetra::Chunk::claim(State from)
 {
-	const uint8_t FACE_INDEX{axis*2U+sign};
-	const float SIGN_OFFSET{sign ? 0.f : 1.f}, SIGN_DIRECTION{sign ? -1.f : 1.f};
+	uint8_t expected{from};
+	return state.compare_exchange_strong(expected, from|CLAIMED);
+}
+
+bool Tetra::Chunk::advance(State to, bool release)
+{
+	//Moves a claimed chunk on, a chunk retired in the meantime stays retiring
+	uint8_t current{state.load()};
+	while(true)
+	{
+		const State FROM{static_cast<State>(current&~CLAIMED)};
+		if(!(current&CLAIMED) || (FROM != RETIRING && !is_transition_valid(FROM, to)))
+			return false;
+		const uint8_t DESIRED{static_cast<uint8_t>((FROM == RETIRING ? RETIRING : to)|
+			(release ? 0 : CLAIMED))};
+		if(state.compare_exchange_weak(current, DESIRED)) return FROM != RETIRING;
+	}
+}
+
+bool Tetra::Chunk::transition(State from, State to)
+{
+	if(!is_transition_valid(from, to)) return false;
+	uint8_t expected{from};
+	return state.compare_exchange_strong(expected, to);
+}
+
+void Tetra::Chunk::retire()
+{
+	uint8_t current{state.load()};
+	while(!state.compare_exchange_weak(current, RETIRING|(current&CLAIMED)));
+}
+
+template<typename Voxels>
+Tetra::Voxel_Grid Tetra::Chunk::create_lod_grid(Mesh_Arena *arena, const Voxels& voxels,
+	uint8_t lod, const Chunk_Neighborhood *neighborhood, uint8_t skirts)
+{
+	const uint8_t SCALE{static_cast<uint8_t>(1<<lod)}, SIZE{static_cast<uint8_t>(CHUNK_SIZE>>lod)};
+	const uint32_t BLOCK_VOXELS{static_cast<uint32_t>(SCALE*SCALE*SCALE)};
+	arena->lod_voxels.resize(SIZE*SIZE*SIZE);
+	Voxel_Grid grid{arena->lod_voxels.data(), SIZE, SCALE, nullptr, 0};
+
+	//Each grid voxel takes the most common material of the block it covers,
+	//or stays empty when more than half of the block is empty
+	constexpr uint8_t MATERIALS{WATER+1};
+	std::vector<uint32_t>& counts{arena->lod_counts};
+	counts.assign(SIZE*SIZE*MATERIALS, 0);
+	uint8_t slab{};
+	const auto FINISH_SLAB{[&]()
+	{
+		for(uint8_t y{}; y < SIZE; ++y)
+			for(uint8_t x{}; x < SIZE; ++x)
+			{
+				const uint32_t *block_counts{&counts[(y*SIZE+x)*MATERIALS]};
+				uint8_t material{};
+				if((BLOCK_VOXELS-block_counts[0])*2 >= BLOCK_VOXELS)
+					for(uint8_t m{STONE}; m <= WATER; ++m)
+						if(!material || block_counts[m] > block_counts[material]) material = m;
+				grid.get(x, y, slab) = {0, material};
+			}
+		std::fill(counts.begin(), counts.end(), 0);
+	}};
+
+	//Runs arrive in voxel order, so only the slab of blocks being read is counted.
+	//Runs are split at row ends and each row segment at block borders.
+	voxels.for_each_run([&](uint32_t first, uint32_t count, uint8_t material)
+	{
+		while(count)
+		{
+			const uint32_t X{first%CHUNK_SIZE}, Y{first/CHUNK_SIZE%CHUNK_SIZE},
+				Z{first/(CHUNK_SIZE*CHUNK_SIZE)}, ROW{std::min(count, CHUNK_SIZE-X)};
+			for(; Z/SCALE != slab; ++slab) FINISH_SLAB();
+			uint32_t *row_counts{&counts[Y/SCALE*SIZE*MATERIALS]};
+			for(uint32_t x{X}, end; x < X+ROW; x = end)
+			{
+				end = std::min(X+ROW, (x/SCALE+1)*SCALE);
+				row_counts[x/SCALE*MATERIALS+material] += end-x;
+			}
+			first += ROW, count -= ROW;
+		}
+	});
+	FINISH_SLAB();
+
+	cull_lod_grid(grid, neighborhood, skirts);
+	return grid;
+}
 
-	Mesh_Data *mesh_data{nullptr};
-	const uint8_t MATERIAL_TYPE{get_material_type(material)};
-	auto iterator{mesh_datas->find(MATERIAL_TYPE)};
-	if(iterator == mesh_datas->end())
-		mesh_data = &mesh_datas->emplace(MATERIAL_TYPE, Mesh_Data{}).first->second;
-	else mesh_data = &iterator->second;
+void Tetra::Chunk::cull_lod_grid(const Voxel_Grid& grid, const Chunk_Neighborhood *neighborhood,
+	uint8_t skirts)
+{
+	//Faces on the grid border are culled against the block the neighbour's grid at the
+	//same level of detail has there. Borders that are skirts, or have no neighbour, stay.
+	for(uint8_t z{}; z < grid.size; ++z)
+		for(uint8_t y{}; y < grid.size; ++y)
+			for(uint8_t x{}; x < grid.size; ++x)
+			{
+				Voxel& voxel{grid.get(x, y, z)};
+				if(is_material_transparent(voxel.material)) continue;
+				for(uint8_t face{}; face < CUBE_FACES; ++face)
+				{
+					const glm::ivec3 NEIGHBOR{glm::ivec3{x, y, z}+glm::ivec3{FACE_NEIGHBORS[face]}};
+					if(glm::any(glm::lessThan(NEIGHBOR, glm::ivec3{0})) ||
+						glm::any(glm::greaterThanEqual(NEIGHBOR, glm::ivec3{grid.size})))
+					{
+						const Chunk *CHUNK{get_face_neighbor(neighborhood, face, skirts)};
+						const int SIZE{grid.size};
+						if(CHUNK && !CHUNK->is_block_transparent((NEIGHBOR+SIZE)%SIZE,
+							grid.scale)) voxel.cull_mask |= 0b1<<face;
+					}
+					else if(!is_material_transparent(grid.get(NEIGHBOR.x, NEIGHBOR.y,
+						NEIGHBOR.z).material)) voxel.cull_mask |= 0b1<<face;
+				}
+			}
+}
+
+bool Tetra::Chunk::is_block_transparent(const glm::ivec3& block, uint8_t scale) const
+{
+	//Whether the voxel a lower detail grid makes of the block is transparent, counted
+	//the way create_lod_grid counts it
+	constexpr uint8_t MATERIALS{WATER+1};
+	uint32_t counts[MATERIALS]{};
+	const glm::ivec3 FIRST{block*static_cast<int>(scale)};
+	for(int z{FIRST.z}; z < FIRST.z+scale; ++z)
+		for(int y{FIRST.y}; y < FIRST.y+scale; ++y)
+			for(int x{FIRST.x}; x < FIRST.x+scale; ++x) ++counts[voxels[z][y][x].material];
+	const uint32_t BLOCK_VOXELS{static_cast<uint32_t>(scale*scale*scale)};
+	if((BLOCK_VOXELS-counts[0])*2 < BLOCK_VOXELS) return true;
+	uint8_t material{};
+	for(uint8_t m{STONE}; m <= WATER; ++m)
+		if(!material || counts[m] > counts[material]) material = m;
+	return is_material_transparent(material);
+}
+
+const Tetra::Chunk *Tetra::Chunk::get_face_neighbor(const Chunk_Neighborhood *neighborhood,
+	uint8_t face, uint8_t skirts)
+{
+	if(!neighborhood || skirts&0b1<<face) return nullptr;
+	const glm::ivec3 OFFSET{FACE_NEIGHBORS[face]};
+	return (*neighborhood)[(OFFSET.z+1)*9+(OFFSET.y+1)*3+OFFSET.x+1];
+}
+
+void Tetra::Chunk::greedy_face(Mesh_Arena *arena, const Voxel_Grid& grid, uint8_t material,
+	uint8_t occlusion, uint8_t axis, uint8_t sign, const glm::fvec3& position,
+	const glm::fvec2& size)
+{
+	const float SIGN_OFFSET{sign ? 0.f : 1.f}, SIGN_DIRECTION{sign ? -1.f : 1.f};
+	const float SCALE{static_cast<float>(grid.scale)};
+	Mesh_Data *mesh_data{&arena->mesh_datas[get_mesh_type(material)]};
 
 	//Vertices
 	const glm::fvec3 V[4]{{position.x, position.y, position.z+SIGN_OFFSET},
@@ -24,94 +164,134 @@ void Tetra::Chunk::greedy_face(std::unordered_map<uint8_t, Mesh_Data> *mesh_data
 		{position.x+size.x+VOXEL_SIZE, position.y+size.y+VOXEL_SIZE, position.z+SIGN_OFFSET},
 		{position.x+size.x+VOXEL_SIZE, position.y, position.z+SIGN_OFFSET}};
 	const glm::fvec2 UV[4]{{0, 0}, {0, size.y+1}, {size.x+1, size.y+1}, {size.x+1, 0}};
-	uint8_t j{};
-	for(uint8_t i{}; i < 4; ++i)
-	{
-		for(j = 0; j < 3; ++j) mesh_data->vertices.push_back(V[i][VERTEX_ORDERS[axis][j]]);
-		for(j = 0; j < 2; ++j) mesh_data->vertices.push_back(
-			UV[axis == Axis::Z ? sign ? i : 3-i : sign ? 3-i : i][j]);
-		for(j = 0; j < 3; ++j)
-			mesh_data->vertices.push_back(NORMAL_AXIS[axis] == j ? SIGN_DIRECTION : 0);
-		mesh_data->vertices.emplace_back(material);
-	}
 
-	//Indices
-	for(uint32_t i{}; i < RECTANGLE_INDICES.size(); ++i)
+	//Corner occlusion, 3 is unoccluded
+	uint8_t O[4];
+	for(uint8_t i{}; i < 4; ++i) O[i] = occlusion>>i*2&0b11;
+
+	//Backfaces are emitted in reverse winding so every quad shares the same index pattern,
+	//and the quad is rotated to split along the diagonal that keeps occlusion isotropic
+	const bool BACKFACE{axis == Axis::Z ? sign == 0 : sign != 0}, FLIP{O[0]+O[2] < O[1]+O[3]};
+	float quad[QUAD_VERTICES*VERTEX_SIZE], *vertex{quad};
+	uint8_t j{};
+	for(uint8_t i : QUAD_ORDERS[BACKFACE][FLIP])
 	{
-		bool backface{axis == Axis::Z ? sign == 0 : sign != 0};
-		uint32_t index{RECTANGLE_INDICES[backface ? (RECTANGLE_INDICES.size()-1)-i : i]};
-		mesh_data->indices.emplace_back(index+4*mesh_data->face);
+		for(j = 0; j < 3; ++j) *vertex++ = V[i][VERTEX_ORDERS[axis][j]]*SCALE;
+		for(j = 0; j < 2; ++j)
+			*vertex++ = UV[axis == Axis::Z ? sign ? i : 3-i : sign ? 3-i : i][j]*SCALE;
+		for(j = 0; j < 3; ++j) *vertex++ = NORMAL_AXIS[axis] == j ? SIGN_DIRECTION : 0;
+		*vertex++ = material;
+		*vertex++ = O[i]/3.f;
 	}
+	mesh_data->vertices.insert(mesh_data->vertices.end(), quad, vertex);
 
 	++mesh_data->face;
+	++mesh_data->direction_faces[axis*2+sign];
 }
 
-Tetra::Voxel Tetra::Chunk::greedy_get(uint8_t axis, uint8_t layer, uint8_t row, uint8_t column)
+Tetra::Voxel Tetra::Chunk::greedy_get(const Voxel_Grid& grid, uint8_t axis, uint8_t layer,
+	uint8_t row, uint8_t column)
 {
-	return axis == Axis::X ? voxels[column][row][layer] : axis == Axis::Y ?
-		voxels[row][layer][column] : voxels[layer][row][column];
+	return axis == Axis::X ? grid.get(layer, row, column) : axis == Axis::Y ?
+		grid.get(column, layer, row) : grid.get(column, row, layer);
 }
 
-uint8_t Tetra::Chunk::get_material_type(uint8_t material)
+bool Tetra::Chunk::is_occluder(const Voxel_Grid& grid, const glm::ivec3& position)
 {
-	if(!material) return NULL;
-	if(material == WATER) return Oreginum::Renderable::Type::VOXEL_TRANSLUCENT;
-	else return Oreginum::Renderable::Type::VOXEL;
+	if(glm::all(glm::greaterThanEqual(position, glm::ivec3{0})) &&
+		glm::all(glm::lessThan(position, glm::ivec3{grid.size})))
+		return !is_material_transparent(grid.get(position.x, position.y, position.z).material);
+	if(!grid.neighborhood) return false;
+
+	//Look the voxel up in the neighbouring chunk it falls in. Across a skirt, or in a
+	//neighbour populated at lower detail, the voxels aren't the ones drawn there, so the
+	//face is left open.
+	glm::ivec3 chunk{}, voxel{position};
+	for(uint8_t axis{}; axis < 3; ++axis)
+		if(voxel[axis] < 0) --chunk[axis], voxel[axis] += CHUNK_SIZE;
+		else if(voxel[axis] >= CHUNK_SIZE) ++chunk[axis], voxel[axis] -= CHUNK_SIZE;
+	for(uint8_t axis{}; axis < 3; ++axis)
+		if(chunk[axis] && grid.skirts&0b1<<(axis*2+(chunk[axis] < 0))) return false;
+	const Chunk *neighbor{(*grid.neighborhood)[(chunk.z+1)*9+(chunk.y+1)*3+chunk.x+1]};
+	return neighbor && !neighbor->get_population_lod() &&
+		!neighbor->is_voxel_transparent(glm::u8vec3(voxel));
 }
 
-void Tetra::Chunk::greedy_main(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas,
-	uint32_t *face, uint8_t axis, uint8_t sign, uint8_t layer)
+uint8_t Tetra::Chunk::get_face_occlusion(const Voxel_Grid& grid, uint8_t axis, uint8_t sign,
+	uint8_t layer, uint8_t row, uint8_t column)
+{
+	//Each corner is darkened by the voxels touching it in the layer in front of the face,
+	//two sides fully occlude it regardless of the diagonal
+	const int FRONT{layer+(sign ? -1 : 1)};
+	uint8_t occlusion{};
+	for(uint8_t i{}; i < 4; ++i)
+	{
+		const int COLUMN{column+OCCLUSION_CORNERS[i][0]}, ROW{row+OCCLUSION_CORNERS[i][1]};
+		const bool SIDE_1{is_occluder(grid, greedy_position(axis, FRONT, row, COLUMN))},
+			SIDE_2{is_occluder(grid, greedy_position(axis, FRONT, ROW, column))},
+			CORNER{is_occluder(grid, greedy_position(axis, FRONT, ROW, COLUMN))};
+		occlusion |= (SIDE_1 && SIDE_2 ? 0 : 3-SIDE_1-SIDE_2-CORNER)<<i*2;
+	}
+	return occlusion;
+}
+
+void Tetra::Chunk::greedy_main(Mesh_Arena *arena, const Voxel_Grid& grid,
+	uint8_t axis, uint8_t sign, uint8_t layer)
 {
 	//Determine face index
-	const uint8_t FACE_INDEX{axis*2U+sign};
+	const uint8_t FACE_INDEX{static_cast<uint8_t>(axis*2U+sign)};
+	const uint8_t SIZE{grid.size};
 
-	//Create meshed mask
-	uint8_t x, y{};
-	bool meshed[CHUNK_SIZE][CHUNK_SIZE];
-	for(; y < CHUNK_SIZE; ++y)
-		for(x = 0; x < CHUNK_SIZE; ++x)
-			meshed[y][x] = false;
+	//Clear meshed mask
+	uint8_t x, y;
+	bool (&meshed)[CHUNK_SIZE][CHUNK_SIZE]{arena->meshed};
+	std::memset(meshed, false, sizeof(arena->meshed));
 
 	//While layer is not meshed
 	glm::u8vec2 position{}, size;
 	Voxel initial_voxel, voxel;
+	uint8_t initial_occlusion;
 	bool found;
 	while(true)
 	{
 		//Find the initial voxel and position
 		found = false;
-		for(y = position.y; y < CHUNK_SIZE && !found; ++y)
+		for(y = position.y; y < SIZE && !found; ++y)
 			for(x = y == position.y ? position.x : 0U;
-				x < CHUNK_SIZE && !found; ++x)
+				x < SIZE && !found; ++x)
 				{
 					if(meshed[y][x]) continue;
-					voxel = greedy_get(axis, layer, y, x);
-					if(!is_face_culled(voxel.cull_mask, FACE_INDEX))
+					voxel = greedy_get(grid, axis, layer, y, x);
+					if(voxel.material && !is_face_culled(voxel.cull_mask, FACE_INDEX))
 						initial_voxel = voxel, position = {x, y}, found = true;
 				}
 		if(!found) break;
+		initial_occlusion = get_face_occlusion(grid, axis, sign, layer, position.y, position.x);
 
 		//Find the width
 		size.x = 0;
-		for(x = position.x+1U; x < CHUNK_SIZE; ++x)
+		for(x = position.x+1U; x < SIZE; ++x, ++size.x)
 		{
-			voxel = greedy_get(axis, layer, position.y, x);
+			voxel = greedy_get(grid, axis, layer, position.y, x);
 			if(meshed[position.y][x] || is_face_culled(voxel.cull_mask, FACE_INDEX) ||
-				voxel.material != initial_voxel.material || x == CHUNK_SIZE-1)
-				{ size.x = (x-1)-position.x; break; }
+				voxel.material != initial_voxel.material || get_face_occlusion(grid,
+				axis, sign, layer, position.y, x) != initial_occlusion) break;
 		}
 
 		//Find the height
 		found = false;
 		size.y = 0;
-		for(y = position.y+1U; y < CHUNK_SIZE && !found; ++y)
+		for(y = position.y+1U; y < SIZE && !found; ++y)
+		{
 			for(x = position.x; x <= position.x+size.x && !found; ++x)
 			{
-				voxel = greedy_get(axis, layer, y, x);
+				voxel = greedy_get(grid, axis, layer, y, x);
 				if(meshed[y][x] || is_face_culled(voxel.cull_mask, FACE_INDEX) ||
-					voxel.material != initial_voxel.material || y == CHUNK_SIZE-1)
-					size.y = (y-1)-position.y, found = true;
+					voxel.material != initial_voxel.material || get_face_occlusion(grid,
+					axis, sign, layer, y, x) != initial_occlusion) found = true;
 			}
+			if(!found) ++size.y;
+		}
 
 		//Update meshed mask
 		for(y = position.y; y <= position.y+size.y; ++y)
@@ -119,38 +299,220 @@ void Tetra::Chunk::greedy_main(std::unordered_map<uint8_t, Mesh_Data> *mesh_data
 				meshed[y][x] = true;
 
 		//Create face
-		greedy_face(mesh_datas, initial_voxel.material, face,
-			axis, sign, glm::fvec3{position, layer}, size);
+		greedy_face(arena, grid, initial_voxel.material, initial_occlusion, axis, sign,
+			glm::fvec3{position, layer}, size);
 	}
 }
 
-void Tetra::Chunk::greedy_mesh_simplification(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas)
+bool Tetra::Chunk::greedy_mesh_simplification(Mesh_Arena *arena, const Voxel_Grid& grid,
+	const Chunk *owner)
 {
-	uint32_t face{};
+	//Faces are emitted direction by direction so each direction is one contiguous range,
+	//an owning chunk retired meanwhile is abandoned between layers
 	for(uint8_t axis{}; axis < 3; ++axis)
 		for(uint8_t sign{}; sign < 2; ++sign)
-			for(uint8_t layer{}; layer < CHUNK_SIZE; ++layer)
-				greedy_main(mesh_datas, &face, axis, sign, layer);
+			for(uint8_t layer{}; layer < grid.size; ++layer)
+			{
+				if(owner && owner->is_retiring()) return false;
+				greedy_main(arena, grid, axis, sign, layer);
+			}
+	return true;
+}
+
+void Tetra::Chunk::reserve_mesh_datas(Mesh_Arena *arena, const Voxel_Grid& grid)
+{
+	//Count visible faces, the greedy mesh can never need more quads than this
+	uint32_t faces[MESH_TYPES]{};
+	for(uint8_t z{}; z < grid.size; ++z)
+		for(uint8_t y{}; y < grid.size; ++y)
+			for(uint8_t x{}; x < grid.size; ++x)
+			{
+				const Voxel& voxel{grid.get(x, y, z)};
+				if(!voxel.material) continue;
+				uint8_t visible{};
+				for(uint8_t face{}; face < CUBE_FACES; ++face)
+					visible += !is_face_culled(voxel.cull_mask, face);
+				faces[get_mesh_type(voxel.material)] += visible;
+			}
+
+	for(uint8_t i{}; i < MESH_TYPES; ++i)
+	{
+		Mesh_Data& mesh_data{arena->mesh_datas[i]};
+		mesh_data.face = 0;
+		mesh_data.direction_faces = {};
+		mesh_data.vertices.clear();
+		mesh_data.vertices.reserve(faces[i]*QUAD_VERTICES*VERTEX_SIZE);
+	}
 }
 
-void Tetra::Chunk::create_mesh()
+bool Tetra::Chunk::create_mesh(Mesh_Arena *arena, uint8_t lod,
+	const Chunk_Neighborhood *neighborhood, uint8_t skirts)
 {
-	if(culled) return;
-	mesh_datas.clear();
-	greedy_mesh_simplification(&mesh_datas);
+	if(culled) return true;
+
+	//Full detail meshes read the chunk directly, lower detail meshes a downsampled copy
+	const Voxel_Grid GRID{lod ? create_lod_grid(arena, *this, lod, neighborhood, skirts) :
+		Voxel_Grid{&voxels[0][0][0], CHUNK_SIZE, 1, neighborhood, skirts}};
+	reserve_mesh_datas(arena, GRID);
+	if(!greedy_mesh_simplification(arena, GRID, this)) return false;
+	this->lod = lod, this->skirts = skirts;
+
+	//Copy out exactly what was meshed, the arena keeps its worst case buffers for the
+	//next chunk
+	for(uint8_t i{}; i < MESH_TYPES; ++i)
+	{
+		const Mesh_Data& MESH_DATA{arena->mesh_datas[i]};
+		mesh_datas[i] = {MESH_DATA.face, MESH_DATA.direction_faces,
+			std::vector<float>(MESH_DATA.vertices.begin(), MESH_DATA.vertices.end())};
+	}
+	return true;
+}
+
+bool Tetra::Chunk::create_mesh(Mesh_Arena *arena, const Chunk_View& view, uint8_t lod)
+{
+	//Full detail needs cull masks and neighbours, which only loaded chunks have
+	if(!lod || lod >= LODS || !view.is_valid()) return false;
+	const Voxel_Grid GRID{create_lod_grid(arena, view, lod)};
+	reserve_mesh_datas(arena, GRID);
+	return greedy_mesh_simplification(arena, GRID, nullptr);
 }
 
+#ifndef TETRA_HEADLESS
 void Tetra::Chunk::create_render_groups()
 {
 	render_groups.clear();
-	for(const auto& m : mesh_datas) render_groups.emplace_back(m.second.vertices,
-		m.second.indices, m.first, translation+world_translation);
-	mesh_datas.clear();
+	render_groups.reserve(MESH_TYPES);
+	for(uint8_t i{}; i < MESH_TYPES; ++i)
+	{
+		if(mesh_datas[i].face) render_groups.emplace_back(mesh_datas[i].vertices,
+			mesh_datas[i].direction_faces, RENDER_TYPES[i], translation+world_translation);
+		mesh_datas[i] = {};
+	}
+	uploaded = true;
 }
 
+std::vector<Tetra::Render_Group> Tetra::Chunk::release_render_groups()
+{
+	remove_render_groups();
+	return std::move(render_groups);
+}
+#endif
+
 void Tetra::Chunk::translate(const glm::fvec3& translation, const glm::u8vec3& index_translation)
 {
 	this->translation += translation;
 	this->index += index_translation;
+#ifndef TETRA_HEADLESS
 	for(Render_Group& r : render_groups) r.translate(translation);
-}
\ No newline at end of file
+#endif
+}
+
+std::vector<uint8_t> Tetra::Chunk::encode() const
+{
+	//Palette of the materials present, in order of appearance
+	const Voxel *VOXELS{&voxels[0][0][0]};
+	std::array<int16_t, UINT8_MAX+1> palette_indices;
+	palette_indices.fill(-1);
+	std::vector<uint8_t> palette;
+	for(uint32_t i{}; i < CHUNK_SIZE_CUBED; ++i) if(palette_indices[VOXELS[i].material] < 0)
+	{
+		palette_indices[VOXELS[i].material] = static_cast<int16_t>(palette.size());
+		palette.push_back(VOXELS[i].material);
+	}
+	uint8_t index_bits{};
+	while((1U<<index_bits) < palette.size()) ++index_bits;
+
+	std::vector<uint8_t> data{static_cast<uint8_t>(palette.size()-1)};
+	data.insert(data.end(), palette.begin(), palette.end());
+
+	//Runs of one material in voxel order, each a varint of the run length above the index
+	for_each_run([&](uint32_t, uint32_t run, uint8_t material)
+	{
+		uint64_t token{static_cast<uint64_t>(run-1)<<index_bits|palette_indices[material]};
+		for(; token >= 0x80; token >>= 7) data.push_back(static_cast<uint8_t>(token|0x80));
+		data.push_back(static_cast<uint8_t>(token));
+	});
+	return data;
+}
+
+bool Tetra::Chunk::decode(const Chunk_View& view)
+{
+	if(!view.is_valid()) return false;
+	Voxel *voxels{&this->voxels[0][0][0]};
+	view.for_each_run([voxels](uint32_t first, uint32_t count, uint8_t material)
+		{ std::fill(voxels+first, voxels+first+count, Voxel{0, material}); });
+	materials_hashed = false;
+	return true;
+}
+
+uint64_t Tetra::Chunk::get_mesh_key(uint8_t lod, const Chunk_Neighborhood *neighborhood,
+	uint8_t skirts) const
+{
+	//Materials are the second byte of each voxel, cull masks are rebuilt when meshing.
+	//Four independent lanes keep the multiplies from waiting on each other.
+	if(!materials_hashed)
+	{
+		constexpr uint64_t MATERIALS{0xFF00FF00FF00FF00};
+		uint64_t lanes[4]{1, 2, 3, 4};
+		const uint8_t *BYTES{reinterpret_cast<const uint8_t *>(&voxels[0][0][0])};
+		for(size_t i{}; i < sizeof(voxels); i += sizeof(lanes))
+			for(uint8_t l{}; l < 4; ++l)
+			{
+				uint64_t word;
+				std::memcpy(&word, BYTES+i+l*sizeof(uint64_t), sizeof(uint64_t));
+				lanes[l] = mix(lanes[l], word&MATERIALS);
+			}
+		materials_hash = mix(mix(mix(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+		materials_hashed = true;
+	}
+	uint64_t key{mix(mix(lod, materials_hash), skirts)};
+
+	//Lower detail culling only sees whether the blocks touching the chunk in each face
+	//neighbour that is not a skirt are transparent
+	const uint8_t SCALE{static_cast<uint8_t>(1<<lod)}, SIZE{static_cast<uint8_t>(CHUNK_SIZE>>lod)};
+	if(lod) for(uint8_t face{}; face < CUBE_FACES; ++face)
+	{
+		const Chunk *NEIGHBOR{get_face_neighbor(neighborhood, face, skirts)};
+		key = mix(key, NEIGHBOR != nullptr);
+		if(!NEIGHBOR) continue;
+		const uint8_t AXIS{static_cast<uint8_t>(face/2)};
+		glm::ivec3 block{};
+		block[AXIS] = FACE_NEIGHBORS[face][AXIS] < 0 ? SIZE-1 : 0;
+		uint64_t bits{};
+		uint8_t count{};
+		for(int row{}; row < SIZE; ++row)
+			for(int column{}; column < SIZE; ++column)
+			{
+				block[(AXIS+1)%3] = row, block[(AXIS+2)%3] = column;
+				bits = bits<<1|NEIGHBOR->is_block_transparent(block, SCALE);
+				if(++count == 64) key = mix(key, bits), bits = 0, count = 0;
+			}
+		key = mix(key, bits);
+	}
+
+	//Full detail culling and occlusion only see whether the layer of voxels touching the
+	//chunk in each neighbour is transparent, skirts are not culled against
+	if(!lod && neighborhood) for(uint8_t n{}; n < 27; ++n)
+	{
+		if(n == 13) continue;
+		const Chunk *NEIGHBOR{(*neighborhood)[n]};
+		key = mix(key, NEIGHBOR != nullptr);
+		if(!NEIGHBOR) continue;
+		const glm::ivec3 OFFSET{n%3-1, n/3%3-1, n/9-1};
+		glm::ivec3 minimum, maximum;
+		for(uint8_t axis{}; axis < 3; ++axis)
+			minimum[axis] = OFFSET[axis] < 0 ? CHUNK_SIZE-1 : 0,
+			maximum[axis] = OFFSET[axis] > 0 ? 0 : CHUNK_SIZE-1;
+		uint64_t bits{};
+		uint8_t count{};
+		for(int z{minimum.z}; z <= maximum.z; ++z)
+			for(int y{minimum.y}; y <= maximum.y; ++y)
+				for(int x{minimum.x}; x <= maximum.x; ++x)
+				{
+					bits = bits<<1|NEIGHBOR->is_voxel_transparent(glm::u8vec3(x, y, z));
+					if(++count == 64) key = mix(key, bits), bits = 0, count = 0;
+				}
+		key = mix(key, bits);
+	}
+	return key;
+}
@@ -1,53 +1,165 @@
 #pragma once
 #include <vector>
 #include <array>
-#include <unordered_map>
+#include <atomic>
+#include <cstring>
 #define GLM_ENABLE_EXPERIMENTAL
 #include "Common.hpp"
+#ifndef TETRA_HEADLESS
 #include "Render Group.hpp"
+#endif
 
 namespace Tetra
 {
+	enum Mesh_Types{VOXEL_MESH, TRANSLUCENT_MESH, MESH_TYPES};
+
+	class Chunk;
+	class Chunk_View;
+	//The chunk itself and its 26 neighbours, indexed by (z+1)*9+(y+1)*3+(x+1)
+	using Chunk_Neighborhood = std::array<const Chunk *, 27>;
+
+	struct Mesh_Data
+	{
+		uint32_t face;
+		std::array<uint32_t, CUBE_FACES> direction_faces;
+		std::vector<float> vertices;
+	};
+
+	//Scratch space owned by a single worker and reused for every chunk it meshes,
+	//so meshing neither hashes materials nor grows its buffers an element at a time
+	struct Mesh_Arena
+	{
+		std::array<Mesh_Data, MESH_TYPES> mesh_datas;
+		bool meshed[CHUNK_SIZE][CHUNK_SIZE];
+		std::vector<Voxel> lod_voxels;
+		std::vector<uint32_t> lod_counts;
+	};
+
+	//A cube of voxels where each voxel spans scale world voxels along every axis,
+	//lookups past its border go to the neighbourhood when there is one, except across
+	//the faces in skirts
+	struct Voxel_Grid
+	{
+		Voxel *voxels;
+		uint8_t size, scale;
+		const Chunk_Neighborhood *neighborhood;
+		uint8_t skirts;
+
+		Voxel& get(uint8_t x, uint8_t y, uint8_t z) const
+		{ return voxels[(z*size+y)*size+x]; }
+	};
+
 	class Chunk
 	{
 	public:
 		Chunk(const glm::fvec3& translation, const glm::fvec3& world_translation,
 			const glm::u8vec3& index);
+	#ifndef TETRA_HEADLESS
 		~Chunk(){ remove_render_groups(); }
+	#endif
 
-		void create_mesh();
+		static constexpr uint8_t LODS{4};
+
+		//Lifecycle, a chunk only moves to the next state, from uploaded back to pass 2
+		//to be remeshed or back to allocated to be populated in more detail, or to
+		//retiring. Jobs claim a chunk before working on it.
+		enum State : uint8_t{ALLOCATED, PASS_1, PASS_2, CULLED, MESHED, UPLOADED, RETIRING};
+
+		//Skirts has a bit per face for the sides towards neighbours meshed at another level
+		//of detail, faces on those borders are never culled so they hide the seams
+		bool create_mesh(Mesh_Arena *arena, uint8_t lod = 0,
+			const Chunk_Neighborhood *neighborhood = nullptr, uint8_t skirts = 0);
+		//Lower detail meshes straight from stored data without a dense chunk, left in the
+		//arena's mesh datas. Only the tools mesh this way, the game decodes stored chunks.
+		static bool create_mesh(Mesh_Arena *arena, const Chunk_View& view, uint8_t lod);
+	#ifndef TETRA_HEADLESS
 		void create_render_groups();
+		std::vector<Render_Group> release_render_groups();
 		void add_render_groups(){ for(Render_Group& r : render_groups) r.add(); }
 		void remove_render_groups(){ for(Render_Group& r : render_groups) r.remove(); }
+	#endif
 
 		void translate(const glm::fvec3& translation, const glm::u8vec3& index_translation);
 
+		//Voxel materials as a palette followed by runs of palette indices, chunks decoded
+		//from storage are marked stored and skip generation. Decoding reads the data in
+		//place through a view, which has already validated it, so an invalid chunk is
+		//left untouched.
+		std::vector<uint8_t> encode() const;
+		bool decode(const Chunk_View& view);
+
+		//Identifies the mesh the chunk would get, from its materials, the level of detail,
+		//the skirts and the transparency of the neighbouring voxels it looks at. The hash of
+		//the materials is kept until they are next written, so only the first key after a
+		//change reads the whole chunk.
+		uint64_t get_mesh_key(uint8_t lod, const Chunk_Neighborhood *neighborhood,
+			uint8_t skirts) const;
+		const std::array<Mesh_Data, MESH_TYPES>& get_mesh_datas() const { return mesh_datas; }
+		void set_mesh_datas(const std::array<Mesh_Data, MESH_TYPES>& mesh_datas, uint8_t lod,
+			uint8_t skirts){ this->mesh_datas = mesh_datas, this->lod = lod, this->skirts = skirts; }
+
 		glm::fvec3 get_translation() const { return translation; }
 		glm::u8vec3 get_index() const { return index; }
-		uint8_t get_voxel_material(const glm::u8vec3& voxel)
+		uint8_t get_voxel_material(const glm::u8vec3& voxel) const
 		{ return voxels[voxel.z][voxel.y][voxel.x].material; }
+		//Calls run(first, count, material) for each run of one material in voxel order
+		template<typename Run> void for_each_run(Run&& run) const
+		{
+			const Voxel *VOXELS{&voxels[0][0][0]};
+			for(uint32_t first{}, end; first < CHUNK_SIZE_CUBED; first = end)
+			{
+				const uint8_t MATERIAL{VOXELS[first].material};
+				for(end = first+1; end < CHUNK_SIZE_CUBED && VOXELS[end].material == MATERIAL; ++end);
+				run(first, end-first, MATERIAL);
+			}
+		}
 		bool is_culled(){ return culled; }
-		bool is_populated(uint8_t pass) const { return populated[pass]; }
-		bool is_meshed() const { return meshed; }
-		bool is_being_created() const { return being_created; }
-		bool is_being_deleted() const { return being_deleted; }
+		bool is_uploaded() const { return uploaded; }
+		bool is_stored() const { return stored; }
+		//Whether both population passes ran over the whole chunk at full detail, only
+		//such chunks are saved
+		bool is_generated() const { return generated; }
+		State get_state() const { return static_cast<State>(state.load()&~CLAIMED); }
+		bool is_claimed() const { return state.load()&CLAIMED; }
+		bool is_retiring() const { return get_state() == RETIRING; }
+		bool is_populated(uint8_t pass) const
+		{ const State STATE{get_state()}; return STATE != RETIRING && STATE > pass; }
+		bool is_meshed() const
+		{ const State STATE{get_state()}; return STATE != RETIRING && STATE >= MESHED; }
+		uint8_t get_lod() const { return lod; }
+		uint8_t get_skirts() const { return skirts; }
+		//Chunks far enough to be meshed at lower detail are generated a block of voxels at
+		//a time, the level of detail of those blocks
+		uint8_t get_population_lod() const { return population_lod; }
+		//The revision of the edits replayed into the chunk when it was last meshed
+		uint32_t get_edit_revision() const { return edit_revision; }
+		size_t get_mesh_bytes() const
+		{
+			size_t bytes{};
+			for(const Mesh_Data& m : mesh_datas) bytes += m.vertices.size()*sizeof(float);
+			return bytes;
+		}
 		const Voxel& get_voxel(const glm::u8vec3& voxel) const
 		{ return voxels[voxel.z][voxel.y][voxel.x]; }
 		bool is_voxel_transparent(const glm::u8vec3& voxel) const
-		{
-			const uint8_t MATERIAL{voxels[voxel.z][voxel.y][voxel.x].material};
-			return MATERIAL == NULL || MATERIAL == WATER;
-		}
+		{ return is_material_transparent(voxels[voxel.z][voxel.y][voxel.x].material); }
+		static bool is_material_transparent(uint8_t material)
+		{ return material == NULL || material == WATER; }
 		bool is_voxel_culled(const glm::u8vec3& voxel)
 		{ return voxels[voxel.z][voxel.y][voxel.x].cull_mask < 0b00111111; }
 
 		void set_culled(bool culled){ this->culled = culled; }
-		void set_populated(uint8_t pass, bool populated){ this->populated[pass] = populated; }
-		void set_meshed(bool meshed){ this->meshed = meshed; }
-		void set_being_created(bool being_created){ this->being_created = being_created; }
-		void set_being_deleted(bool being_deleted){ this->being_deleted = being_deleted; }
+		void set_stored(bool stored){ this->stored = stored; }
+		void set_generated(bool generated){ this->generated = generated; }
+		void set_edit_revision(uint32_t edit_revision){ this->edit_revision = edit_revision; }
+		void set_population_lod(uint8_t population_lod){ this->population_lod = population_lod; }
+		void clear_voxels(){ std::memset(voxels, 0, sizeof(voxels)), materials_hashed = false; }
+		bool claim(State from);
+		bool advance(State to, bool release = true);
+		bool transition(State from, State to);
+		void retire();
 		void set_voxel_material(const glm::u8vec3& voxel, uint8_t material)
-		{ voxels[voxel.z][voxel.y][voxel.x].material = material; }
+		{ voxels[voxel.z][voxel.y][voxel.x].material = material, materials_hashed = false; }
 		void set_voxel_culled(const glm::u8vec3& voxel, bool culled, uint8_t face = 6)
 		{
 			if(face > 5) voxels[voxel.z][voxel.y][voxel.x].cull_mask |= 0b00111111;
@@ -58,31 +170,67 @@ namespace Tetra
 	private:
 		static constexpr uint8_t VERTEX_ORDERS[3][3]{{2, 1, 0}, {0, 2, 1}, {0, 1, 2}},
 			NORMAL_AXIS[3]{0, 1, 2};
-		static constexpr std::array<uint16_t, 6> RECTANGLE_INDICES{0, 1, 2, 2, 3, 0};
-
-		struct Mesh_Data
-		{
-			uint32_t face;
-			std::vector<float> vertices;
-			std::vector<uint32_t> indices;
-		};
+		static constexpr uint8_t QUAD_ORDERS[2][2][4]{{{0, 1, 2, 3}, {1, 2, 3, 0}},
+			{{0, 3, 2, 1}, {3, 2, 1, 0}}};
+		static constexpr int8_t OCCLUSION_CORNERS[4][2]{{-1, -1}, {-1, 1}, {1, 1}, {1, -1}};
+		static constexpr glm::i8vec3 FACE_NEIGHBORS[CUBE_FACES]{{1, 0, 0}, {-1, 0, 0},
+			{0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+	#ifdef TETRA_HEADLESS
+		//Tools build chunks without the renderer, meshes keep the render group layout
+		static constexpr uint8_t VERTEX_SIZE{10}, QUAD_VERTICES{4};
+	#else
+		static constexpr uint8_t VERTEX_SIZE{10}, QUAD_VERTICES{Render_Group::QUAD_VERTICES};
+		static constexpr uint8_t RENDER_TYPES[MESH_TYPES]{Oreginum::Renderable::Type::VOXEL,
+			Oreginum::Renderable::Type::VOXEL_TRANSLUCENT};
+	#endif
+		static constexpr uint8_t CLAIMED{0b10000000};
 
-		bool culled, populated[2], meshed, being_created, being_deleted;
+		bool culled, uploaded, stored;
+		mutable bool materials_hashed;
+		mutable uint64_t materials_hash;
+		std::atomic<bool> generated;
+		std::atomic<uint8_t> state;
 		Voxel voxels[CHUNK_SIZE][CHUNK_SIZE][CHUNK_SIZE];
 		glm::fvec3 translation, world_translation;
+	#ifndef TETRA_HEADLESS
 		std::vector<Render_Group> render_groups;
-		std::unordered_map<uint8_t, Mesh_Data> mesh_datas;
+	#endif
+		std::array<Mesh_Data, MESH_TYPES> mesh_datas;
 		glm::u8vec3 index;
+		uint8_t lod, skirts, population_lod;
+		uint32_t edit_revision;
 
-		void greedy_face(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas,
-			uint8_t material, uint32_t *face, uint8_t axis, uint8_t sign,
-			const glm::fvec3& position, const glm::fvec2& size);
-		Voxel greedy_get(uint8_t axis, uint8_t layer, uint8_t row, uint8_t column);
-		uint8_t get_material_type(uint8_t material);
-		bool is_face_culled(uint8_t cull_mask, uint8_t face_index)
+		static uint64_t mix(uint64_t hash, uint64_t value)
+		{ hash = (hash^value)*0x9E3779B97F4A7C15; return hash^hash>>32; }
+		static bool is_transition_valid(State from, State to){ return to == RETIRING ||
+			to == from+1 || (from == UPLOADED && (to == PASS_2 || to == ALLOCATED)); }
+		template<typename Voxels>
+		static Voxel_Grid create_lod_grid(Mesh_Arena *arena, const Voxels& voxels, uint8_t lod,
+			const Chunk_Neighborhood *neighborhood = nullptr, uint8_t skirts = 0);
+		static void cull_lod_grid(const Voxel_Grid& grid, const Chunk_Neighborhood *neighborhood,
+			uint8_t skirts);
+		bool is_block_transparent(const glm::ivec3& block, uint8_t scale) const;
+		static const Chunk *get_face_neighbor(const Chunk_Neighborhood *neighborhood,
+			uint8_t face, uint8_t skirts);
+		static void greedy_face(Mesh_Arena *arena, const Voxel_Grid& grid, uint8_t material,
+			uint8_t occlusion, uint8_t axis, uint8_t sign, const glm::fvec3& position,
+			const glm::fvec2& size);
+		static glm::ivec3 greedy_position(uint8_t axis, int layer, int row, int column)
+		{ return axis == Axis::X ? glm::ivec3{layer, row, column} : axis == Axis::Y ?
+			glm::ivec3{column, layer, row} : glm::ivec3{column, row, layer}; }
+		static Voxel greedy_get(const Voxel_Grid& grid, uint8_t axis, uint8_t layer,
+			uint8_t row, uint8_t column);
+		static bool is_occluder(const Voxel_Grid& grid, const glm::ivec3& position);
+		static uint8_t get_face_occlusion(const Voxel_Grid& grid, uint8_t axis, uint8_t sign,
+			uint8_t layer, uint8_t row, uint8_t column);
+		static uint8_t get_mesh_type(uint8_t material){ return material == WATER ?
+			Mesh_Types::TRANSLUCENT_MESH : Mesh_Types::VOXEL_MESH; }
+		static bool is_face_culled(uint8_t cull_mask, uint8_t face_index)
 		{ return cull_mask&(0b1<<face_index); }
-		void greedy_main(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas,
-			uint32_t *face, uint8_t axis, uint8_t sign, uint8_t layer);
-		void greedy_mesh_simplification(std::unordered_map<uint8_t, Mesh_Data> *mesh_datas);
+		static void greedy_main(Mesh_Arena *arena, const Voxel_Grid& grid,
+			uint8_t axis, uint8_t sign, uint8_t layer);
+		static bool greedy_mesh_simplification(Mesh_Arena *arena, const Voxel_Grid& grid,
+			const Chunk *owner);
+		static void reserve_mesh_datas(Mesh_Arena *arena, const Voxel_Grid& grid);
 	};
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <vector>
 #include <ctime>
 #include <random>
+#include <functional>
 #include <GLM/glm.hpp>
 
 namespace Tetra
@@ -21,12 +22,19 @@ namespace Tetra
 	
 	static uint32_t SEED = generateRandomSeed();
 	const glm::uvec3 WORLD_SIZE{8, 2, 8};
-	constexpr uint8_t CHUNK_SIZE{128}, CUBE_FACES{6}, THREADS{4}, CHUNKS_ADDED_PER_FRAME{1};
+	constexpr uint8_t CHUNK_SIZE{128}, CUBE_FACES{6};
 	constexpr uint32_t CHUNK_SIZE_CUBED{CHUNK_SIZE*CHUNK_SIZE*CHUNK_SIZE};
 	static constexpr float VOXEL_SIZE{1.f};
 
 	struct Voxel{ uint8_t cull_mask, material; };
 
+	// Hash function for glm::ivec3
+	struct ivec3_hash {
+		std::size_t operator()(const glm::ivec3& v) const {
+			return std::hash<int>()(v.x) ^ (std::hash<int>()(v.y) << 1) ^ (std::hash<int>()(v.z) << 2);
+		}
+	};
+
 	static const glm::u8vec3 TREE_SIZE{5, 7, 5};
 	static constexpr uint8_t TREE[7][5][5]
 	{
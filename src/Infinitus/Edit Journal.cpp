@@ -0,0 +1,151 @@
+#include <cstdio>
+#include <filesystem>
+#include "Edit Journal.hpp"
+
+Tetra::Edit_Journal::Edit_Journal(const std::string& directory) : directory(directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+}
+
+uint32_t Tetra::Edit_Journal::get_edits(const glm::ivec3& chunk_position,
+	std::vector<Edit> *edits)
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	const Region *REGION{get_region(chunk_position)};
+	const auto CHUNK{REGION->chunks.find(get_chunk_index(chunk_position))};
+	edits->clear();
+	if(CHUNK == REGION->chunks.end()) return 0;
+	edits->reserve(CHUNK->second.edits.size());
+	for(const auto& e : CHUNK->second.edits) edits->push_back({e.first, e.second});
+	return CHUNK->second.revision;
+}
+
+uint32_t Tetra::Edit_Journal::get_revision(const glm::ivec3& chunk_position)
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	const Region *REGION{get_region(chunk_position)};
+	const auto CHUNK{REGION->chunks.find(get_chunk_index(chunk_position))};
+	return CHUNK == REGION->chunks.end() ? 0 : CHUNK->second.revision;
+}
+
+void Tetra::Edit_Journal::load(const glm::ivec3& chunk_position)
+{
+	//The journal is read unlocked, a copy loaded meanwhile by another thread is kept
+	//as it may already hold newer edits
+	const glm::ivec3 REGION_POSITION{get_region_position(chunk_position)};
+	{
+		std::lock_guard<std::mutex> guard{mutex};
+		if(regions.count(REGION_POSITION)) return;
+	}
+	bool compactable;
+	std::unique_ptr<Region> loaded{read_region(REGION_POSITION, &compactable)};
+
+	std::lock_guard<std::mutex> guard{mutex};
+	std::unique_ptr<Region>& region{regions[REGION_POSITION]};
+	if(region) return;
+	region = std::move(loaded);
+	if(compactable) compact(region.get());
+}
+
+bool Tetra::Edit_Journal::record(const glm::ivec3& chunk_position,
+	uint32_t voxel, uint8_t material, bool replace)
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	Region *region{get_region(chunk_position)};
+	const uint16_t CHUNK_INDEX{get_chunk_index(chunk_position)};
+	Chunk_Edits *chunk{&region->chunks[CHUNK_INDEX]};
+	if(!replace && chunk->edits.count(voxel)) return false;
+	apply(chunk, voxel, material);
+
+	//Records are buffered by the stream and reach the disk on the next flush
+	if(!region->file.is_open())
+		region->file.open(region->path, std::ios::binary|std::ios::app);
+	const Record RECORD{CHUNK_INDEX, material, 0, voxel};
+	region->file.write(reinterpret_cast<const char *>(&RECORD), sizeof(Record));
+	region->dirty = true;
+	return true;
+}
+
+void Tetra::Edit_Journal::flush()
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	for(auto& pair : regions) if(pair.second->dirty)
+	{
+		pair.second->file.flush();
+		pair.second->dirty = false;
+		if(!pair.second->file) pair.second->file.close(), pair.second->file.clear();
+	}
+}
+
+Tetra::Edit_Journal::Region *Tetra::Edit_Journal::get_region(const glm::ivec3& chunk_position)
+{
+	const glm::ivec3 REGION_POSITION{get_region_position(chunk_position)};
+	std::unique_ptr<Region>& region{regions[REGION_POSITION]};
+	if(region) return region.get();
+
+	bool compactable;
+	region = read_region(REGION_POSITION, &compactable);
+	if(compactable) compact(region.get());
+	return region.get();
+}
+
+std::unique_ptr<Tetra::Edit_Journal::Region> Tetra::Edit_Journal::read_region(
+	const glm::ivec3& region_position, bool *compactable) const
+{
+	//Replay the whole journal in order, later records replace earlier ones
+	std::unique_ptr<Region> region{std::make_unique<Region>()};
+	region->path = directory+"/r."+std::to_string(region_position.x)+"."+
+		std::to_string(region_position.y)+"."+std::to_string(region_position.z)+".edits";
+	region->dirty = false;
+	*compactable = false;
+	std::ifstream input{region->path, std::ios::binary|std::ios::ate};
+	if(!input) return region;
+	const std::streamoff SIZE{input.tellg()};
+	std::vector<Record> records(static_cast<size_t>(SIZE)/sizeof(Record));
+	input.seekg(0);
+	input.read(reinterpret_cast<char *>(records.data()), records.size()*sizeof(Record));
+	input.close();
+	size_t edits{};
+	for(const Record& r : records)
+		if(r.voxel < CHUNK_SIZE_CUBED) apply(&region->chunks[r.chunk], r.voxel, r.material);
+	for(const auto& pair : region->chunks) edits += pair.second.edits.size();
+
+	//Journals mostly rewriting the same voxels, or ending in a record cut short, are
+	//rewritten with one record per live edit
+	*compactable = records.size() > edits*COMPACTION_RATIO || SIZE%sizeof(Record);
+	return region;
+}
+
+glm::ivec3 Tetra::Edit_Journal::get_region_position(const glm::ivec3& chunk_position)
+{ return glm::floor(glm::fvec3(chunk_position)/static_cast<float>(REGION_SIZE)); }
+
+uint16_t Tetra::Edit_Journal::get_chunk_index(const glm::ivec3& chunk_position)
+{
+	const glm::ivec3 LOCAL{chunk_position&(REGION_SIZE-1)};
+	return static_cast<uint16_t>((LOCAL.z*REGION_SIZE+LOCAL.y)*REGION_SIZE+LOCAL.x);
+}
+
+void Tetra::Edit_Journal::apply(Chunk_Edits *chunk, uint32_t voxel, uint8_t material)
+{
+	++chunk->revision;
+	chunk->edits[voxel] = material;
+}
+
+void Tetra::Edit_Journal::compact(Region *region)
+{
+	const std::string TEMPORARY{region->path+".tmp"};
+	{
+		std::ofstream output{TEMPORARY, std::ios::binary|std::ios::trunc};
+		for(const auto& pair : region->chunks) for(const auto& e : pair.second.edits)
+		{
+			const Record RECORD{pair.first, e.second, 0, e.first};
+			output.write(reinterpret_cast<const char *>(&RECORD), sizeof(Record));
+		}
+		if(!output) return;
+	}
+
+	//The old journal stays in place unless the new one is complete
+	std::error_code error;
+	std::filesystem::rename(TEMPORARY, region->path, error);
+}
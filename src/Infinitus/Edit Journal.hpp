@@ -0,0 +1,77 @@
+#pragma once
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <unordered_map>
+#include <string>
+#include "Common.hpp"
+
+namespace Tetra
+{
+	//Voxels changed after generation, kept as a journal per region of 16x16x16 chunks
+	//and replayed over the regenerated chunk when it loads. Each edit is appended as one
+	//fixed size record, so disk use grows with edits rather than with chunks visited, and
+	//a region's journal is read with one sequential read the first time it is touched.
+	//Workers load journals ahead of the main thread, which then only finds them loaded.
+	class Edit_Journal
+	{
+	public:
+		struct Edit{ uint32_t voxel; uint8_t material; };
+
+		Edit_Journal(const std::string& directory);
+		~Edit_Journal(){ flush(); }
+
+		//The chunk's edits, newest material per voxel, and its revision, which grows
+		//with every edit so meshes built from older edits can be told apart
+		uint32_t get_edits(const glm::ivec3& chunk_position, std::vector<Edit> *edits);
+		uint32_t get_revision(const glm::ivec3& chunk_position);
+		//Reads the journal of the chunk's region unless it is loaded, without holding up
+		//threads using other regions meanwhile
+		void load(const glm::ivec3& chunk_position);
+		//Unless replacing, voxels that already have an edit keep it, whether the edit was
+		//recorded is returned
+		bool record(const glm::ivec3& chunk_position, uint32_t voxel, uint8_t material,
+			bool replace = true);
+		void flush();
+
+	private:
+		static constexpr int32_t REGION_SIZE{16};
+		//Journals holding more than this many records per live edit are rewritten
+		static constexpr uint32_t COMPACTION_RATIO{2};
+
+		struct Record
+		{
+			uint16_t chunk;
+			uint8_t material, padding;
+			uint32_t voxel;
+		};
+		static_assert(sizeof(Record) == 8, "Journal records are 8 bytes");
+
+		//Newest material per voxel
+		struct Chunk_Edits
+		{
+			std::unordered_map<uint32_t, uint8_t> edits;
+			uint32_t revision;
+		};
+
+		struct Region
+		{
+			std::string path;
+			std::unordered_map<uint16_t, Chunk_Edits> chunks;
+			std::ofstream file;
+			bool dirty;
+		};
+
+		std::string directory;
+		std::unordered_map<glm::ivec3, std::unique_ptr<Region>, ivec3_hash> regions;
+		std::mutex mutex;
+
+		Region *get_region(const glm::ivec3& chunk_position);
+		std::unique_ptr<Region> read_region(const glm::ivec3& region_position,
+			bool *compactable) const;
+		static glm::ivec3 get_region_position(const glm::ivec3& chunk_position);
+		static uint16_t get_chunk_index(const glm::ivec3& chunk_position);
+		static void apply(Chunk_Edits *chunk, uint32_t voxel, uint8_t material);
+		static void compact(Region *region);
+	};
+}
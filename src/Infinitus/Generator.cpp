@@ -0,0 +1,287 @@
+#include <algorithm>
+#include "FastNoiseSIMD/FastNoiseSIMD.h"
+#include "Generator.hpp"
+
+Tetra::Generator::Generator(uint32_t seed, const std::function<Chunk *(const glm::ivec3&)>& get_chunk,
+	const Defer_Voxel& defer_voxel) : seed(seed), get_chunk(get_chunk), defer_voxel(defer_voxel){}
+
+glm::ivec3 Tetra::Generator::get_chunk_position(const Chunk *chunk)
+{ return glm::ivec3{glm::floor(chunk->get_translation()/static_cast<float>(CHUNK_SIZE))}; }
+
+float Tetra::Generator::get_random(const glm::ivec3& position, uint32_t seed)
+{
+	// A hash of the position rather than a shared generator, so a column gets the same
+	// value whichever order chunks generate in and edits can be replayed over it
+	uint32_t value{seed};
+	for(uint8_t axis{}; axis < 3; ++axis)
+		value ^= static_cast<uint32_t>(position[axis])+0x9E3779B9+(value<<6)+(value>>2);
+	value ^= value>>16, value *= 0x85EBCA6B, value ^= value>>13;
+	value *= 0xC2B2AE35, value ^= value>>16;
+	return (value>>8)/16777216.f;
+}
+
+float *Tetra::Generator::simplex(const glm::ivec3& offset, const glm::ivec3& size,
+	float frequency, uint32_t octaves, uint32_t seed, uint8_t scale)
+{
+	FastNoiseSIMD *generator{FastNoiseSIMD::NewFastNoiseSIMD(seed)};
+	generator->SetFrequency(frequency);
+	generator->SetFractalOctaves(octaves);
+	float *set{generator->GetSimplexFractalSet(offset.x,
+		offset.y, offset.z, size.x, size.y, size.z, scale)};
+	delete generator;
+	return set;
+}
+
+void Tetra::Generator::populate_chunk_pass_1(Tetra::Chunk *chunk, uint8_t lod)
+{
+	// Get chunk position in world coordinates
+	glm::ivec3 chunk_world_pos = get_chunk_position(chunk);
+	glm::ivec3 chunk_offset = chunk_world_pos * static_cast<int>(CHUNK_SIZE);
+	
+	//Noise is sampled at the first voxel of each block, which is a single voxel at full
+	//detail. Chunks populated before at lower detail are cleared first.
+	const uint8_t SCALE{static_cast<uint8_t>(1<<lod)}, SIZE{static_cast<uint8_t>(CHUNK_SIZE>>lod)};
+	const glm::ivec3 CHUNK_OFFSET{chunk_offset/static_cast<int>(SCALE)},
+		OFFSET_2D{CHUNK_OFFSET.z, CHUNK_OFFSET.x, 0}, SIZE_2D{SIZE, SIZE, 1};
+	constexpr uint8_t RISES_BASES_HEIGHT{20}, EARTH_RANGE{50}, MOUNTAINOUSNESS_RANGE{200};
+	if(chunk->get_population_lod()) chunk->clear_voxels();
+	chunk->set_population_lod(lod);
+
+	float *mountainousness_set{simplex(OFFSET_2D, SIZE_2D, .003f, 7, seed, SCALE)};
+
+	float *earth_set{simplex(OFFSET_2D, SIZE_2D, .0005f, 1, seed+1, SCALE)};
+	float *hills_set{simplex(OFFSET_2D, SIZE_2D, .01f, 2, seed+2, SCALE)};
+	float *detail_set{simplex(OFFSET_2D, SIZE_2D, .01f, 1, seed+3, SCALE)};
+	float *plateau_height_set{simplex(OFFSET_2D, SIZE_2D, .003f, 2, seed+5, SCALE)};
+
+	//The 3D plateau noise is filled a z slab at a time, so a chunk
+	//retired meanwhile is abandoned between slabs
+	FastNoiseSIMD *plateau_fill_generator{FastNoiseSIMD::NewFastNoiseSIMD(seed+4)};
+	plateau_fill_generator->SetFrequency(.002f);
+	plateau_fill_generator->SetFractalOctaves(7);
+	float *plateau_fill_set{FastNoiseSIMD::GetEmptySet(SIZE*SIZE)};
+		
+	//Create ground
+	uint32_t noise_index_2d{}, noise_index_3d{};
+	for(uint8_t z{}; z < SIZE && !chunk->is_retiring(); ++z)
+	{
+		plateau_fill_generator->FillSimplexFractalSet(plateau_fill_set, CHUNK_OFFSET.z+z,
+			CHUNK_OFFSET.x, CHUNK_OFFSET.y, 1, SIZE, SIZE, SCALE);
+		noise_index_3d = 0;
+		for(uint8_t x{}; x < SIZE; ++x)
+		{
+			for(uint8_t y{}; y < SIZE; ++y)
+			{
+				const float MOUNTAINOUSNESS{std::max(
+					mountainousness_set[noise_index_2d]*
+					MOUNTAINOUSNESS_RANGE, 0.f)};
+
+				float VOXEL_Y{static_cast<float>(chunk_offset.y + y*SCALE)};
+
+				const float EARTH{earth_set[noise_index_2d]*EARTH_RANGE};
+				const float HILLS{hills_set[noise_index_2d]*5*MOUNTAINOUSNESS/30};
+				const float DETAIL{detail_set[noise_index_2d]*2};
+				const float GROUND{EARTH+HILLS+DETAIL};
+
+				const float PLATEAU_HEIGHT{EARTH+plateau_height_set[noise_index_2d]*
+					MOUNTAINOUSNESS-RISES_BASES_HEIGHT+DETAIL};
+				const float PLATEAU{VOXEL_Y > PLATEAU_HEIGHT ?
+					plateau_fill_set[noise_index_3d]*(VOXEL_Y-PLATEAU_HEIGHT) : 0};
+
+				if(VOXEL_Y > GROUND || PLATEAU > .1)
+					for(uint8_t block_z{}; block_z < SCALE; ++block_z)
+						for(uint8_t block_y{}; block_y < SCALE; ++block_y)
+							for(uint8_t block_x{}; block_x < SCALE; ++block_x)
+								chunk->set_voxel_material({x*SCALE+block_x, y*SCALE+block_y,
+									z*SCALE+block_z}, Materials::STONE);
+
+				++noise_index_3d;
+			}
+			++noise_index_2d;
+		}
+	}
+
+	delete plateau_fill_generator;
+	FastNoiseSIMD::FreeNoiseSet(plateau_height_set);
+	FastNoiseSIMD::FreeNoiseSet(plateau_fill_set);
+	FastNoiseSIMD::FreeNoiseSet(detail_set);
+	FastNoiseSIMD::FreeNoiseSet(hills_set);
+	FastNoiseSIMD::FreeNoiseSet(earth_set);
+	FastNoiseSIMD::FreeNoiseSet(mountainousness_set);
+}
+
+bool Tetra::Generator::axis_bounds_check(glm::u8vec3 values, glm::u8vec3 minimum, glm::u8vec3 maximum)
+{
+	for(uint8_t axis{}; axis < 3; ++axis)
+		if(values[axis] < minimum[axis] || values[axis] > maximum[axis]) return true;
+	return false;
+}
+
+void Tetra::Generator::inter_chunk_set(Tetra::Chunk *chunk, glm::i16vec3 voxel_index, uint8_t material)
+{
+	//If outside current chunk
+	if(axis_bounds_check(glm::u8vec3(voxel_index), glm::u8vec3{0}, glm::u8vec3{CHUNK_SIZE-1}))
+	{
+		// Calculate which chunk this voxel belongs to
+		glm::ivec3 current_chunk_pos = get_chunk_position(chunk);
+		glm::ivec3 target_chunk_pos = current_chunk_pos;
+		
+		// Adjust chunk position and voxel index based on which boundary was crossed
+		for(uint8_t axis = 0; axis < 3; ++axis)
+		{
+			if(voxel_index[axis] < 0) 
+			{
+				--target_chunk_pos[axis];
+				voxel_index[axis] = static_cast<int16_t>(CHUNK_SIZE) + voxel_index[axis];
+			}
+			else if(voxel_index[axis] >= CHUNK_SIZE) 
+			{
+				++target_chunk_pos[axis];
+				voxel_index[axis] = voxel_index[axis] - static_cast<int16_t>(CHUNK_SIZE);
+			}
+		}
+
+		// Try to find the target chunk
+		Tetra::Chunk* target_chunk = get_chunk(target_chunk_pos);
+		if(target_chunk && !target_chunk->is_retiring() && !target_chunk->is_stored())
+		{
+			target_chunk->set_voxel_material(glm::u8vec3(voxel_index), material);
+		}
+		// Chunks that don't exist, are being deleted or were read from storage never
+		// hold the voxel, those not generated yet may be dropped before they are saved
+		// or populated again in more detail, and those already meshed don't show it, so
+		// the voxel is deferred for them
+		if(defer_voxel && (!target_chunk || target_chunk->is_retiring() ||
+			!target_chunk->is_generated() || target_chunk->is_meshed()))
+			defer_voxel(target_chunk_pos, glm::u8vec3(voxel_index), material);
+	}
+	//If inside current chunk
+	else 
+	{
+		chunk->set_voxel_material(glm::u8vec3(voxel_index), material);
+	}
+}
+
+void Tetra::Generator::create_tree(Tetra::Chunk *chunk, glm::i16vec3 base_voxel_index)
+{
+	base_voxel_index -= glm::i16vec3{TREE_SIZE.x/2, 0, TREE_SIZE.z/2};
+
+	for(int8_t y{}; y < TREE_SIZE.y; ++y)
+		for(int8_t x{}; x < TREE_SIZE.x; ++x)
+			for(int8_t z{}; z < TREE_SIZE.z; ++z)
+			{
+				glm::i16vec3 voxel_index{base_voxel_index};
+				voxel_index += glm::i16vec3{x, -y, z}; // Flip Y to account for downward-increasing coordinates
+				uint8_t material{TREE[y][z][x]};
+				if(!material) continue;
+				inter_chunk_set(chunk, voxel_index, material);
+			}
+}
+
+bool Tetra::Generator::populate_chunk_pass_2(Tetra::Chunk *chunk)
+{
+	const glm::ivec3 chunk_world_pos = chunk->get_translation();
+	const glm::ivec3 CHUNK_OFFSET{chunk_world_pos.x, chunk_world_pos.y, chunk_world_pos.z};
+	const glm::ivec3 OFFSET_2D{CHUNK_OFFSET.z, CHUNK_OFFSET.x, 0};
+	const glm::ivec3 SIZE_2D{CHUNK_SIZE, CHUNK_SIZE, 1};
+
+	float *tree_area_set{simplex(OFFSET_2D, SIZE_2D, .003f, 5, seed+6)};
+
+	// Chunks populated a block at a time have equal columns across each block, the
+	// first column of the block is worked out and copied to the others
+	const uint8_t SCALE{static_cast<uint8_t>(1<<chunk->get_population_lod())};
+	
+	// Process each column (x,z) in this chunk, abandoning retired chunks between slabs
+	for(uint8_t voxel_z{}; voxel_z < CHUNK_SIZE && !chunk->is_retiring(); voxel_z += SCALE)
+	{
+		for(uint8_t voxel_x{}; voxel_x < CHUNK_SIZE; voxel_x += SCALE)
+		{
+			const uint32_t noise_index_2d{static_cast<uint32_t>(voxel_z*CHUNK_SIZE+voxel_x)};
+
+			// Find the surface level for this column by scanning from top to bottom  
+			// Since Y increases downward, Y=0 is "top" and Y=CHUNK_SIZE-1 is "bottom"
+			int surface_y = -1;
+			bool water_surface = false;
+			
+			// First pass: find surface level (scan from top Y=0 to bottom Y=CHUNK_SIZE-1)
+			for(int voxel_y = 0; voxel_y < CHUNK_SIZE; ++voxel_y)
+			{
+				glm::u8vec3 voxel_index{voxel_x, static_cast<uint8_t>(voxel_y), voxel_z};
+				uint8_t voxel_material = chunk->get_voxel_material(voxel_index);
+				float world_y = static_cast<float>(chunk_world_pos.y + voxel_y);
+				
+				// If we find solid material (stone from pass 1), this is our surface
+				if(voxel_material == Materials::STONE)
+				{
+					surface_y = voxel_y;
+					break;
+				}
+				// If we're below water level and no solid found yet, check for water placement  
+				else if(world_y >= -10 && world_y <= -5 && voxel_material == 0 && surface_y == -1)
+				{
+					// This could be water surface
+					water_surface = true;
+					surface_y = voxel_y;
+				}
+			}
+			
+			// Second pass: assign materials based on distance from surface
+			for(uint8_t voxel_y{}; voxel_y < CHUNK_SIZE; ++voxel_y)
+			{
+				glm::u8vec3 voxel_index{voxel_x, voxel_y, voxel_z};
+				uint8_t voxel_material = chunk->get_voxel_material(voxel_index);
+				float world_y = static_cast<float>(chunk_world_pos.y + voxel_y);
+				
+				// Calculate depth from surface
+				int depth_from_surface = surface_y >= 0 ? static_cast<int>(voxel_y) - surface_y : -999;
+				
+				// Water placement - only in empty spaces that are below water level
+				if(world_y >= -10 && world_y <= -5 && voxel_material == 0)
+				{
+					chunk->set_voxel_material(voxel_index, Materials::WATER);
+					voxel_material = Materials::WATER;
+				}
+				// Sand near water level - only replace stone that's near water
+				else if(world_y >= -10 && world_y <= -3 && voxel_material == Materials::STONE && surface_y >= 0 && depth_from_surface >= -2 && depth_from_surface <= 2)
+				{
+					chunk->set_voxel_material(voxel_index, Materials::SAND);
+				}
+				// Surface and subsurface materials
+				else if(voxel_material == Materials::STONE && surface_y >= 0)
+				{
+					if(depth_from_surface == 0) // Surface
+					{
+						chunk->set_voxel_material(voxel_index, Materials::GRASS);
+						
+						// Only place trees on actual surface blocks, and only at full detail
+						float random = get_random(chunk_world_pos+glm::ivec3(voxel_index), seed+7)*20.0f;
+						const bool TREE = SCALE == 1 &&
+							random < std::max(tree_area_set[noise_index_2d], 0.0f);
+						if(TREE)
+						{
+							// Place tree base at the grass block
+							glm::i16vec3 tree_base = glm::i16vec3(voxel_index);
+							create_tree(chunk, tree_base);
+						}
+					}
+					else if(depth_from_surface > 0 && depth_from_surface <= 4) // Below surface (dirt layer)
+					{
+						chunk->set_voxel_material(voxel_index, Materials::DIRT);
+					}
+					// Stone remains stone for deeper areas
+				}
+			}
+			
+			if(SCALE > 1) for(uint8_t voxel_y{}; voxel_y < CHUNK_SIZE; ++voxel_y)
+			{
+				const uint8_t MATERIAL{chunk->get_voxel_material({voxel_x, voxel_y, voxel_z})};
+				for(uint8_t z{}; z < SCALE; ++z)
+					for(uint8_t x{}; x < SCALE; ++x)
+						chunk->set_voxel_material({voxel_x+x, voxel_y, voxel_z+z}, MATERIAL);
+			}
+		}
+	}
+
+	FastNoiseSIMD::FreeNoiseSet(tree_area_set);
+	return !chunk->is_retiring();
+}
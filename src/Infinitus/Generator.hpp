@@ -0,0 +1,40 @@
+#pragma once
+#include <functional>
+#include "Common.hpp"
+#include "Chunk.hpp"
+
+namespace Tetra
+{
+	//Procedural terrain from the world's seed. The first pass fills a chunk from noise,
+	//the second lays surface materials, water and trees, and writes the parts of trees
+	//reaching past the chunk into the neighbours get_chunk finds. Those parts are also
+	//handed to defer_voxel when the neighbour may not keep or show them: it is missing,
+	//retiring, stored, not fully generated itself, or already meshed. Chunks only meshed
+	//at lower detail are filled a block of voxels per noise sample, and get no trees.
+	class Generator
+	{
+	public:
+		typedef std::function<void(const glm::ivec3&, const glm::u8vec3&, uint8_t)> Defer_Voxel;
+
+		Generator(uint32_t seed, const std::function<Chunk *(const glm::ivec3&)>& get_chunk,
+			const Defer_Voxel& defer_voxel = {});
+
+		uint32_t get_seed() const { return seed; }
+		void populate_chunk_pass_1(Chunk *chunk, uint8_t lod = 0);
+		//Whether every column was populated, retired chunks are abandoned partway
+		bool populate_chunk_pass_2(Chunk *chunk);
+
+	private:
+		uint32_t seed;
+		std::function<Chunk *(const glm::ivec3&)> get_chunk;
+		Defer_Voxel defer_voxel;
+
+		static glm::ivec3 get_chunk_position(const Chunk *chunk);
+		float *simplex(const glm::ivec3& offset, const glm::ivec3& size,
+			float frequency, uint32_t octaves, uint32_t seed, uint8_t scale = 1);
+		static float get_random(const glm::ivec3& position, uint32_t seed);
+		bool axis_bounds_check(glm::u8vec3 values, glm::u8vec3 minimum, glm::u8vec3 maximum);
+		void inter_chunk_set(Chunk *chunk, glm::i16vec3 voxel_index, uint8_t material);
+		void create_tree(Chunk *chunk, glm::i16vec3 base_voxel_index);
+	};
+}
@@ -1,10 +1,14 @@
 #include <string>
+#include <cstdio>
+#include <cstdlib>
 #include <thread>
 #include "../Oreginum/Window.hpp"
 #include "../Oreginum/Core.hpp"
 #include "../Oreginum/Camera.hpp"
 #include "../Oreginum/Mouse.hpp"
 #include "../Oreginum/Keyboard.hpp"
+#include "../Oreginum/Main Renderer.hpp"
+#include "../Oreginum/Job System.hpp"
 #include "World.hpp"
 
 int WinMain(HINSTANCE current, HINSTANCE previous, LPSTR arguments, int show)
@@ -13,9 +17,36 @@ int WinMain(HINSTANCE current, HINSTANCE previous, LPSTR arguments, int show)
 	SetPriorityClass(GetCurrentProcess(), HIGH_PRIORITY_CLASS);
 	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
 
-	//Initialize
-	Oreginum::Core::initialize("Voxceleron2", {1920, 1080}, false);
-	Tetra::World world{};
+	//Initialize, with a terminal for the job system benchmark or world statistics
+	const bool JOB_BENCHMARK{std::string{arguments}.find("-job_benchmark") != std::string::npos},
+		FLY_THROUGH{std::string{arguments}.find("-fly_through") != std::string::npos},
+		STATISTICS{FLY_THROUGH || std::string{arguments}.find("-statistics") != std::string::npos};
+	Oreginum::Core::initialize("Voxceleron2", {1920, 1080}, false, JOB_BENCHMARK || STATISTICS);
+	if(JOB_BENCHMARK) for(uint32_t iterations : {1000U, 100000U, 1000000U})
+	{
+		const Oreginum::Job_System::Benchmark_Result RESULT{
+			Oreginum::Job_System::benchmark(2000, iterations)};
+		printf("Jobs of %u iterations: pool %.0f jobs/s, thread per job %.0f jobs/s\n",
+			iterations, RESULT.pool_jobs_per_second, RESULT.spawn_jobs_per_second);
+	}
+	const size_t CHUNK_MEMORY{std::string{arguments}.find("-chunk_memory=")};
+	Tetra::World world{std::string{arguments}.find("-edit_journals") != std::string::npos ?
+		Tetra::World::EDITS : Tetra::World::SNAPSHOTS, CHUNK_MEMORY == std::string::npos ?
+		Tetra::World::DEFAULT_CHUNK_MEMORY_BUDGET : std::strtoull(arguments+CHUNK_MEMORY+
+		sizeof("-chunk_memory=")-1, nullptr, 10)*1024*1024};
+	float statistics_time{Oreginum::Core::get_time()};
+	uint64_t statistics_uploads{world.get_upload_statistics().uploads},
+		statistics_holes{world.get_visible_holes()},
+		statistics_saved_bytes{world.get_save_statistics().written_bytes};
+
+	//The fly-through heads straight along the initial view at running speed
+	constexpr float FLY_THROUGH_SPEED{150.f}, FLY_THROUGH_SECONDS{60.f};
+	const glm::fvec3 FLY_THROUGH_DIRECTION{
+		glm::normalize(Oreginum::Camera::get_direction()*glm::fvec3{1, 0, 1})};
+	const float FLY_THROUGH_START{Oreginum::Core::get_time()};
+	const uint64_t FLY_THROUGH_HOLES{world.get_visible_holes()};
+	bool flying{FLY_THROUGH};
+	constexpr float EDIT_DISTANCE{64.f};
 
 	//Main loop
 	while(Oreginum::Core::update())
@@ -24,7 +55,65 @@ int WinMain(HINSTANCE current, HINSTANCE previous, LPSTR arguments, int show)
 		if(Oreginum::Keyboard::was_pressed(Oreginum::Key::L))
 			Oreginum::Mouse::set_locked(!Oreginum::Mouse::is_locked());
 
+		//Break the voxel looked at with the left mouse button, or place stone against it
+		//with the right one
+		const bool BREAK{Oreginum::Mouse::was_pressed(Oreginum::LEFT_MOUSE)},
+			PLACE{Oreginum::Mouse::was_pressed(Oreginum::RIGHT_MOUSE)};
+		glm::ivec3 hit, previous;
+		if(Oreginum::Mouse::is_locked() && (BREAK || PLACE) && world.raycast(
+			Oreginum::Camera::get_position(), Oreginum::Camera::get_direction(),
+			EDIT_DISTANCE, &hit, &previous))
+			world.set_voxel(BREAK ? hit : previous, BREAK ? 0 : Tetra::STONE);
+
+		//Screen space ambient occlusion toggle
+		if(Oreginum::Keyboard::was_pressed(Oreginum::Key::O))
+			Oreginum::Main_Renderer::set_screen_space_ambient_occlusion(
+				!Oreginum::Main_Renderer::get_screen_space_ambient_occlusion());
+
+		//Fly, then report the holes seen over the whole flight
+		if(flying)
+		{
+			Oreginum::Camera::set_position(Oreginum::Camera::get_position()+
+				FLY_THROUGH_DIRECTION*FLY_THROUGH_SPEED*Oreginum::Core::get_delta());
+			const float FLIGHT_TIME{Oreginum::Core::get_time()-FLY_THROUGH_START};
+			if(FLIGHT_TIME >= FLY_THROUGH_SECONDS)
+			{
+				printf("Fly-through: %.2f visible holes/s over %.0f s\n",
+					(world.get_visible_holes()-FLY_THROUGH_HOLES)/FLIGHT_TIME, FLIGHT_TIME);
+				flying = false;
+			}
+		}
+
 		world.update();
+
+		//Print world statistics every second
+		if(STATISTICS && Oreginum::Core::get_time()-statistics_time >= 1)
+		{
+			const Tetra::Upload_Scheduler::Statistics& UPLOADS{world.get_upload_statistics()};
+			const float ELAPSED{Oreginum::Core::get_time()-statistics_time};
+			const Tetra::World::Crossing_Statistics& CROSSINGS{world.get_crossing_statistics()};
+			const Tetra::Mesh_Cache::Statistics MESHES{world.get_mesh_cache_statistics()};
+			const Tetra::Region_Store::Statistics SAVES{world.get_save_statistics()};
+			printf("Uploads: %.0f/s, %zu queued, %.1f ms latency, %.2f ms budget, %.0f MB/s, "
+				"%.2f ms record, holes: %.1f/s, last crossing: %zu chunks in %.3f ms (%.3f ms max), "
+				"mesh cache: %llu hits, %llu misses, %zu meshes in %.0f MB, "
+				"saves: %zu queued in %.1f MB, %.2f MB/s, %llu failed, %llu recovered, %llu corrupt\n",
+				(UPLOADS.uploads-statistics_uploads)/ELAPSED, UPLOADS.queue_depth,
+				UPLOADS.latency*1000, UPLOADS.budget*1000, UPLOADS.bytes_per_second/1000000,
+				UPLOADS.record_seconds*1000,
+				(world.get_visible_holes()-statistics_holes)/ELAPSED, CROSSINGS.chunks,
+				CROSSINGS.seconds*1000, CROSSINGS.maximum_seconds*1000,
+				static_cast<unsigned long long>(MESHES.hits),
+				static_cast<unsigned long long>(MESHES.misses), MESHES.meshes,
+				MESHES.bytes/1000000.f, SAVES.queue_depth, SAVES.pending_bytes/1000000.f,
+				(SAVES.written_bytes-statistics_saved_bytes)/ELAPSED/1000000,
+				static_cast<unsigned long long>(SAVES.failed_writes),
+				static_cast<unsigned long long>(SAVES.recovered_chunks),
+				static_cast<unsigned long long>(SAVES.corrupt_chunks));
+			statistics_time = Oreginum::Core::get_time(), statistics_uploads = UPLOADS.uploads,
+				statistics_holes = world.get_visible_holes(),
+				statistics_saved_bytes = SAVES.written_bytes;
+		}
 	}
 
 	Oreginum::Core::destroy();
@@ -0,0 +1,54 @@
+#include "Mesh Cache.hpp"
+
+bool Tetra::Mesh_Cache::get(const Key& key, Chunk *chunk)
+{
+	std::shared_ptr<const Mesh_Datas> mesh_datas;
+	{
+		std::lock_guard<std::mutex> guard{mutex};
+		const auto ENTRY{index.find(key.hash)};
+		if(ENTRY == index.end() || !(ENTRY->second->key == key)){ ++statistics.misses; return false; }
+
+		//Most recently used meshes are kept at the front
+		entries.splice(entries.begin(), entries, ENTRY->second);
+		mesh_datas = ENTRY->second->mesh_datas;
+		++statistics.hits;
+	}
+	chunk->set_mesh_datas(*mesh_datas, key.lod, key.skirts);
+	return true;
+}
+
+void Tetra::Mesh_Cache::put(const Key& key, const Chunk& chunk)
+{
+	size_t bytes{sizeof(Entry)+sizeof(Mesh_Datas)};
+	for(const Mesh_Data& m : chunk.get_mesh_datas()) bytes += m.vertices.size()*sizeof(float);
+	if(bytes > budget) return;
+
+	//The copy is made before locking, workers only wait on each other for the list.
+	//A mesh whose hash collides with another's replaces it.
+	Entry entry{key, std::make_shared<const Mesh_Datas>(chunk.get_mesh_datas()), bytes};
+	std::lock_guard<std::mutex> guard{mutex};
+	const auto EXISTING{index.find(key.hash)};
+	if(EXISTING != index.end())
+	{
+		if(EXISTING->second->key == key) return;
+		statistics.bytes -= EXISTING->second->bytes;
+		entries.erase(EXISTING->second);
+		index.erase(EXISTING);
+	}
+	entries.push_front(std::move(entry));
+	index[key.hash] = entries.begin();
+	statistics.bytes += bytes;
+	while(statistics.bytes > budget)
+	{
+		statistics.bytes -= entries.back().bytes;
+		index.erase(entries.back().key.hash);
+		entries.pop_back();
+	}
+	statistics.meshes = entries.size();
+}
+
+Tetra::Mesh_Cache::Statistics Tetra::Mesh_Cache::get_statistics()
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	return statistics;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Chunk.hpp"
+
+namespace Tetra
+{
+	//Finished meshes kept in memory by the key of the chunk contents they were built from,
+	//so a chunk meshed again unchanged, such as one reloaded when its area is revisited,
+	//goes straight to upload. The least recently used meshes are dropped beyond the budget.
+	//Nothing is written to disk, the cache only lasts for the run.
+	class Mesh_Cache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t hits, misses;
+			size_t meshes, bytes;
+		};
+
+		//Meshes are found by the hash of the chunk contents, the rest of the key is
+		//compared on a hit so a colliding hash from another chunk or edit is a miss
+		struct Key
+		{
+			glm::ivec3 chunk_position;
+			uint32_t edit_revision;
+			uint64_t hash;
+			uint8_t lod, skirts;
+
+			bool operator==(const Key& other) const
+			{
+				return chunk_position == other.chunk_position &&
+					edit_revision == other.edit_revision && hash == other.hash &&
+					lod == other.lod && skirts == other.skirts;
+			}
+		};
+
+		Mesh_Cache(size_t budget) : budget(budget){}
+
+		bool get(const Key& key, Chunk *chunk);
+		void put(const Key& key, const Chunk& chunk);
+
+		Statistics get_statistics();
+
+	private:
+		typedef std::array<Mesh_Data, MESH_TYPES> Mesh_Datas;
+
+		//Meshes are shared so they are copied in and out without holding the lock
+		struct Entry
+		{
+			Key key;
+			std::shared_ptr<const Mesh_Datas> mesh_datas;
+			size_t bytes;
+		};
+
+		size_t budget;
+		std::list<Entry> entries;
+		std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+		Statistics statistics{};
+		std::mutex mutex;
+	};
+}
@@ -0,0 +1,349 @@
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <filesystem>
+#include <unordered_set>
+#include "Region Store.hpp"
+
+Tetra::Region_Store::Region_Store(const std::string& directory, uint32_t seed)
+	: directory(directory), seed(seed)
+{
+	//A stored world keeps its seed, so regenerated chunks match stored ones
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	std::ifstream seed_input{directory+"/Seed"};
+	if(!(seed_input >> this->seed))
+	{
+		this->seed = seed;
+		std::ofstream{directory+"/Seed"} << seed;
+	}
+
+	writer = std::thread{&Region_Store::write_chunks, this};
+}
+
+Tetra::Region_Store::~Region_Store()
+{
+	//Finish every queued write first
+	{
+		std::lock_guard<std::mutex> guard{mutex};
+		quitting = true;
+	}
+	write_condition.notify_one();
+	writer.join();
+}
+
+bool Tetra::Region_Store::contains(const glm::ivec3& chunk_position)
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	const Region *REGION{get_region(chunk_position)};
+	return pending.count(chunk_position) ||
+		REGION->header.table[get_entry_index(chunk_position)].size;
+}
+
+bool Tetra::Region_Store::read(const glm::ivec3& chunk_position,
+	const std::function<bool(const uint8_t *, size_t)>& reader)
+{
+	std::unique_lock<std::mutex> lock{mutex};
+	Region *region{get_region(chunk_position)};
+
+	//Chunks still waiting to be written are read from memory
+	const auto PENDING{pending.find(chunk_position)};
+	if(PENDING != pending.end())
+	{
+		const Data DATA{PENDING->second};
+		lock.unlock();
+		return reader(DATA->data(), DATA->size());
+	}
+
+	const Entry ENTRY{region->header.table[get_entry_index(chunk_position)]};
+	if(!ENTRY.size) return false;
+	if(!region->mapping || region->mapping->get_size() < uint64_t{ENTRY.offset}+ENTRY.size)
+		region->mapping = std::make_shared<const Oreginum::Mapped_File>(region->path);
+	const std::shared_ptr<const Oreginum::Mapped_File> MAPPING{region->mapping};
+	lock.unlock();
+
+	if(MAPPING->get_size() < uint64_t{ENTRY.offset}+ENTRY.size) return false;
+	const uint8_t *DATA{MAPPING->get_data()+ENTRY.offset};
+	if(get_checksum(DATA, ENTRY.size) != ENTRY.checksum)
+	{
+		std::lock_guard<std::mutex> guard{mutex};
+		++statistics.corrupt_chunks;
+		return false;
+	}
+	return reader(DATA, ENTRY.size);
+}
+
+void Tetra::Region_Store::write(const glm::ivec3& chunk_position, std::vector<uint8_t>&& data)
+{
+	{
+		std::lock_guard<std::mutex> guard{mutex};
+		const Data DATA{std::make_shared<const std::vector<uint8_t>>(std::move(data))};
+		pending[chunk_position] = DATA;
+		writes.emplace_back(chunk_position, DATA);
+		++statistics.queue_depth, statistics.pending_bytes += DATA->size();
+	}
+	write_condition.notify_one();
+}
+
+bool Tetra::Region_Store::is_backlogged()
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	return statistics.pending_bytes > PENDING_BUDGET;
+}
+
+Tetra::Region_Store::Statistics Tetra::Region_Store::get_statistics()
+{
+	std::lock_guard<std::mutex> guard{mutex};
+	return statistics;
+}
+
+Tetra::Region_Store::Region *Tetra::Region_Store::get_region(const glm::ivec3& chunk_position)
+{
+	const glm::ivec3 REGION_POSITION{glm::floor(glm::fvec3(chunk_position)/
+		static_cast<float>(REGION_SIZE))};
+	std::unique_ptr<Region>& region{regions[REGION_POSITION]};
+	if(region) return region.get();
+
+	//Recover an existing region file, anything else, older versions too, is written from
+	//scratch
+	region = std::make_unique<Region>();
+	region->path = directory+"/r."+std::to_string(REGION_POSITION.x)+"."+
+		std::to_string(REGION_POSITION.y)+"."+std::to_string(REGION_POSITION.z)+".region";
+	region->mapping = std::make_shared<const Oreginum::Mapped_File>(region->path);
+	std::memset(&region->header, 0, sizeof(Header));
+	region->size = 0;
+	region->recovered = false;
+	uint32_t format[2]{};
+	if(region->mapping->get_size() >= sizeof(format))
+		std::memcpy(format, region->mapping->get_data(), sizeof(format));
+	if(format[0] == MAGIC && format[1] == VERSION) recover_region(region.get());
+
+	//Anything after the last complete block is cut off so new blocks follow it directly,
+	//the file is mapped again when it is read
+	if(region->size && region->mapping->get_size() > region->size)
+	{
+		region->mapping.reset();
+		std::error_code error;
+		std::filesystem::resize_file(region->path, region->size, error);
+	}
+	if(!region->size) region->mapping.reset();
+	return region.get();
+}
+
+void Tetra::Region_Store::recover_region(Region *region)
+{
+	const uint8_t *DATA{region->mapping->get_data()};
+	const uint64_t SIZE{region->mapping->get_size()};
+	if(SIZE < sizeof(Header)) return;
+
+	//The table holds every block before committed unless it was torn while written,
+	//then it is rebuilt from the start
+	std::memcpy(&region->header, DATA, sizeof(Header));
+	const std::vector<Entry> STORED(region->header.table, region->header.table+REGION_CHUNKS);
+	uint64_t position{region->header.committed};
+	if(region->header.checksum != get_table_checksum(position, region->header.table) ||
+		position < sizeof(Header) || position > SIZE)
+	{
+		std::memset(region->header.table, 0, sizeof(region->header.table));
+		position = sizeof(Header), region->recovered = true;
+	}
+
+	//Replay every complete block after it, only block indices are read. A block is
+	//complete when its index is intact and its records end within the file.
+	while(position+sizeof(Block) <= SIZE)
+	{
+		Block block;
+		std::memcpy(&block, DATA+position, sizeof(Block));
+		const uint64_t INDEX_END{position+sizeof(Block)+uint64_t{block.chunks}*sizeof(Block_Entry)};
+		if(block.magic != BLOCK_MAGIC || !block.chunks || block.chunks > REGION_CHUNKS ||
+			INDEX_END > SIZE || get_checksum(DATA+position+sizeof(Block),
+			block.chunks*sizeof(Block_Entry)) != block.checksum) break;
+
+		std::vector<Block_Entry> entries(block.chunks);
+		std::memcpy(entries.data(), DATA+position+sizeof(Block), block.chunks*sizeof(Block_Entry));
+		uint64_t end{INDEX_END};
+		for(const Block_Entry& e : entries)
+		{
+			if(e.index >= REGION_CHUNKS || e.entry.offset != end || end+e.entry.size > SIZE)
+			{
+				end = 0;
+				break;
+			}
+			end += e.entry.size;
+		}
+		if(!end) break;
+		for(const Block_Entry& e : entries) region->header.table[e.index] = e.entry;
+		position = end, region->recovered = true;
+	}
+
+	//Only chunks whose entry differs from the one stored were recovered
+	for(uint32_t i{}; i < REGION_CHUNKS; ++i)
+		if(std::memcmp(&STORED[i], &region->header.table[i], sizeof(Entry)))
+			++statistics.recovered_chunks;
+	region->header.committed = static_cast<uint32_t>(position);
+	region->size = position;
+}
+
+uint32_t Tetra::Region_Store::get_entry_index(const glm::ivec3& chunk_position)
+{
+	const glm::ivec3 LOCAL{chunk_position&(REGION_SIZE-1)};
+	return (LOCAL.z*REGION_SIZE+LOCAL.y)*REGION_SIZE+LOCAL.x;
+}
+
+uint32_t Tetra::Region_Store::get_checksum(const void *data, size_t size, uint32_t checksum)
+{
+	//CRC-32 as zip uses it, a byte at a time, continuing from the given checksum
+	static const std::array<uint32_t, 256> TABLE{[]
+		{
+			std::array<uint32_t, 256> table;
+			for(uint32_t i{}; i < 256; ++i)
+			{
+				uint32_t c{i};
+				for(uint8_t k{}; k < 8; ++k) c = c&1 ? 0xEDB88320^c>>1 : c>>1;
+				table[i] = c;
+			}
+			return table;
+		}()};
+	const uint8_t *bytes{static_cast<const uint8_t *>(data)};
+	checksum = ~checksum;
+	for(size_t i{}; i < size; ++i) checksum = TABLE[(checksum^bytes[i])&0xFF]^checksum>>8;
+	return ~checksum;
+}
+
+uint32_t Tetra::Region_Store::get_table_checksum(uint32_t committed, const Entry *table)
+{
+	return get_checksum(table, REGION_CHUNKS*sizeof(Entry),
+		get_checksum(&committed, sizeof(committed)));
+}
+
+void Tetra::Region_Store::write_chunks()
+{
+	std::unique_lock<std::mutex> lock{mutex};
+	while(true)
+	{
+		write_condition.wait(lock, [this]{ return quitting || !writes.empty(); });
+		if(writes.empty()) return;
+
+		//Take every queued write, only the newest of each chunk is written, grouped by region
+		std::deque<std::pair<glm::ivec3, Data>> taken;
+		taken.swap(writes);
+		std::unordered_set<glm::ivec3, ivec3_hash> newest;
+		std::unordered_map<Region *, std::vector<std::pair<uint32_t, Data>>> batches;
+		for(auto write{taken.rbegin()}; write != taken.rend(); ++write)
+			if(newest.insert(write->first).second) batches[get_region(write->first)].
+				emplace_back(get_entry_index(write->first), write->second);
+
+		//Only this thread touches region files, tables are updated once the records are
+		//on disk. A failed write leaves the previous records, or none, in place.
+		lock.unlock();
+		std::vector<std::pair<Region *, std::vector<Entry>>> written;
+		std::unordered_set<Region *> failed;
+		uint64_t failed_writes{};
+		for(const auto& batch : batches)
+		{
+			std::vector<Entry> entries;
+			if(write_region(batch.first, batch.second, &entries))
+				written.emplace_back(batch.first, std::move(entries));
+			else failed.insert(batch.first), failed_writes += batch.second.size();
+		}
+		lock.lock();
+		statistics.failed_writes += failed_writes;
+
+		for(const auto& region : written)
+		{
+			const std::vector<std::pair<uint32_t, Data>>& CHUNKS{batches[region.first]};
+			for(size_t i{}; i < CHUNKS.size(); ++i)
+			{
+				region.first->header.table[CHUNKS[i].first] = region.second[i];
+				++statistics.written_chunks, statistics.written_bytes += region.second[i].size;
+			}
+			region.first->size = uint64_t{region.second.back().offset}+region.second.back().size;
+			region.first->header.committed = static_cast<uint32_t>(region.first->size);
+			region.first->recovered = false;
+		}
+
+		//Writes to regions that failed stay pending and are retried after a delay, ahead
+		//of newer writes queued meanwhile, until the store is destroyed
+		std::deque<std::pair<glm::ivec3, Data>> retries;
+		for(const std::pair<glm::ivec3, Data>& write : taken)
+		{
+			if(!quitting && failed.count(get_region(write.first)))
+			{
+				retries.push_back(write);
+				continue;
+			}
+			const auto PENDING{pending.find(write.first)};
+			if(PENDING != pending.end() && PENDING->second == write.second) pending.erase(PENDING);
+			--statistics.queue_depth, statistics.pending_bytes -= write.second->size();
+		}
+		if(retries.empty()) continue;
+		writes.insert(writes.begin(), retries.begin(), retries.end());
+		write_condition.wait_for(lock, RETRY_DELAY, [this]{ return quitting; });
+	}
+}
+
+bool Tetra::Region_Store::write_region(Region *region,
+	const std::vector<std::pair<uint32_t, Data>>& chunks, std::vector<Entry> *entries)
+{
+	if(!region->file.is_open())
+	{
+		//New, or unreadable, region files start with an empty table
+		if(!region->size)
+		{
+			region->file.open(region->path, std::ios::binary|std::ios::in|
+				std::ios::out|std::ios::trunc);
+			Header header{};
+			header.magic = MAGIC, header.version = VERSION, header.committed = sizeof(Header);
+			header.checksum = get_table_checksum(header.committed, header.table);
+			region->file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+			if(region->file) region->size = sizeof(Header);
+		}
+		else region->file.open(region->path, std::ios::binary|std::ios::in|std::ios::out);
+		if(!region->file){ region->file.close(), region->file.clear(); return false; }
+	}
+
+	//The records are appended as one block after their index
+	const size_t INDEX_SIZE{sizeof(Block)+chunks.size()*sizeof(Block_Entry)};
+	std::vector<uint8_t> block(INDEX_SIZE);
+	std::vector<Block_Entry> index;
+	uint64_t offset{region->size+INDEX_SIZE};
+	uint32_t first{REGION_CHUNKS}, last{};
+	for(const std::pair<uint32_t, Data>& c : chunks)
+	{
+		if(offset+c.second->size() > UINT32_MAX) return false;
+		entries->push_back({static_cast<uint32_t>(offset), static_cast<uint32_t>(c.second->size()),
+			get_checksum(c.second->data(), c.second->size())});
+		index.push_back({c.first, entries->back()});
+		block.insert(block.end(), c.second->begin(), c.second->end());
+		offset += c.second->size();
+		first = std::min(first, c.first), last = std::max(last, c.first);
+	}
+	const Block BLOCK{BLOCK_MAGIC, static_cast<uint32_t>(chunks.size()),
+		get_checksum(index.data(), index.size()*sizeof(Block_Entry))};
+	std::memcpy(block.data(), &BLOCK, sizeof(Block));
+	std::memcpy(block.data()+sizeof(Block), index.data(), index.size()*sizeof(Block_Entry));
+	region->file.seekp(region->size);
+	region->file.write(reinterpret_cast<const char *>(block.data()), block.size());
+	region->file.flush();
+
+	//Then the span of the table they change, or all of it after recovery, this thread is
+	//the only one changing tables. A crash before this is undone by replaying the block.
+	std::vector<Entry> table(region->header.table, region->header.table+REGION_CHUNKS);
+	for(size_t i{}; i < chunks.size(); ++i) table[chunks[i].first] = (*entries)[i];
+	if(region->recovered) first = 0, last = REGION_CHUNKS-1;
+	const uint32_t COMMITTED[2]{get_table_checksum(static_cast<uint32_t>(offset), table.data()),
+		static_cast<uint32_t>(offset)};
+	region->file.seekp(offsetof(Header, table)+first*sizeof(Entry));
+	region->file.write(reinterpret_cast<const char *>(table.data()+first),
+		(last-first+1)*sizeof(Entry));
+	region->file.seekp(offsetof(Header, checksum));
+	region->file.write(reinterpret_cast<const char *>(COMMITTED), sizeof(COMMITTED));
+	region->file.flush();
+	if(region->file) return true;
+
+	//Reopen on the next write
+	region->file.close();
+	region->file.clear();
+	return false;
+}
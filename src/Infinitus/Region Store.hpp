@@ -0,0 +1,107 @@
+#pragma once
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <fstream>
+#include <unordered_map>
+#include <string>
+#include "Common.hpp"
+#include "../Oreginum/Mapped File.hpp"
+
+namespace Tetra
+{
+	//Chunks persisted in region files of 16x16x16 chunks. A region file starts with a table
+	//of the offset, size and checksum of each chunk's newest record. Records are only ever
+	//appended, in blocks led by an index of the table entries they change, and the table is
+	//rewritten once the block is on disk. Reads go through a memory mapping of the file,
+	//writes are made by a background thread that takes every queued write at once and
+	//appends each region's block, then its table, in one write each. Chunks whose region
+	//failed to write stay queued, counting against the backlog, and are retried.
+	//A region is recovered when first opened from its headers alone: blocks appended after
+	//the table are replayed from their indices, a torn table is rebuilt from every index,
+	//and anything after the last complete block is cut off. Files of an older version are
+	//written again from scratch. A record that fails its checksum is not read, so the
+	//chunk is generated again.
+	//Files are never compacted, a replaced record stays behind as dead space. The world
+	//only saves a chunk again when its record could not be read, so files grow with the
+	//chunks stored rather than with how often they are visited.
+	class Region_Store
+	{
+	public:
+		struct Statistics
+		{
+			size_t queue_depth, pending_bytes;
+			uint64_t written_chunks, written_bytes, failed_writes, recovered_chunks, corrupt_chunks;
+		};
+
+		Region_Store(const std::string& directory, uint32_t seed);
+		~Region_Store();
+
+		//The seed the stored world was generated with, the given one for a new world
+		uint32_t get_seed() const { return seed; }
+		bool contains(const glm::ivec3& chunk_position);
+		bool read(const glm::ivec3& chunk_position,
+			const std::function<bool(const uint8_t *, size_t)>& reader);
+		void write(const glm::ivec3& chunk_position, std::vector<uint8_t>&& data);
+
+		//Whether queued writes hold more memory than the budget, callers producing them
+		//should wait, writes are never refused
+		bool is_backlogged();
+		Statistics get_statistics();
+
+	private:
+		static constexpr int32_t REGION_SIZE{16};
+		static constexpr uint32_t REGION_CHUNKS{REGION_SIZE*REGION_SIZE*REGION_SIZE},
+			MAGIC{0x47525856}, BLOCK_MAGIC{0x4B4C4256}, VERSION{2};
+		static constexpr size_t PENDING_BUDGET{32*1024*1024};
+		static constexpr std::chrono::milliseconds RETRY_DELAY{500};
+
+		struct Entry{ uint32_t offset, size, checksum; };
+		//The checksum covers the table and the end of the blocks it holds
+		struct Header
+		{
+			uint32_t magic, version, checksum, committed;
+			Entry table[REGION_CHUNKS];
+		};
+		//A block's index, followed by its records in order, the checksum covers the index
+		struct Block{ uint32_t magic, chunks, checksum; };
+		struct Block_Entry{ uint32_t index; Entry entry; };
+		typedef std::shared_ptr<const std::vector<uint8_t>> Data;
+
+		//The mapping is replaced once it no longer covers the newest records, readers
+		//keep the one they started with alive
+		struct Region
+		{
+			std::string path;
+			Header header;
+			std::shared_ptr<const Oreginum::Mapped_File> mapping;
+			std::fstream file;
+			uint64_t size;
+			//Whether the table on disk is older than the one recovered
+			bool recovered;
+		};
+
+		std::string directory;
+		uint32_t seed;
+		std::unordered_map<glm::ivec3, std::unique_ptr<Region>, ivec3_hash> regions;
+		std::unordered_map<glm::ivec3, Data, ivec3_hash> pending;
+		std::deque<std::pair<glm::ivec3, Data>> writes;
+		Statistics statistics{};
+		std::mutex mutex;
+		std::condition_variable write_condition;
+		bool quitting{};
+		std::thread writer;
+
+		Region *get_region(const glm::ivec3& chunk_position);
+		static uint32_t get_entry_index(const glm::ivec3& chunk_position);
+		static uint32_t get_checksum(const void *data, size_t size, uint32_t checksum = 0);
+		static uint32_t get_table_checksum(uint32_t committed, const Entry *table);
+		void recover_region(Region *region);
+		void write_chunks();
+		bool write_region(Region *region,
+			const std::vector<std::pair<uint32_t, Data>>& chunks, std::vector<Entry> *entries);
+	};
+}
@@ -1,31 +1,55 @@
+#include <algorithm>
+#include <memory>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/transform.hpp>
 #include "../Oreginum/Camera.hpp"
+#include "../Oreginum/Main Renderer.hpp"
+#include "Common.hpp"
 #include "Render Group.hpp"
+#include "../Oreginum/Texture Array.hpp"
+#include "../Oreginum/Resource Pack.hpp"
+#include "../Oreginum/Mapped File.hpp"
 
 Oreginum::Vulkan::Sampler Tetra::Render_Group::sampler;
 Oreginum::Vulkan::Descriptor_Set Tetra::Render_Group::descriptor_set;
 Oreginum::Texture Tetra::Render_Group::texture_map;
+Oreginum::Vulkan::Buffer Tetra::Render_Group::quad_index_buffer;
 
-Tetra::Render_Group::Render_Group(const std::vector<float>& vertices, const std::vector<uint32_t>& indices,
-	uint8_t material_type, const glm::fvec3& translation) :
-	material_type(material_type), translation(translation)
+Tetra::Render_Group::Render_Group(const std::vector<float>& vertices,
+	const std::array<uint32_t, DIRECTIONS>& direction_quads,
+	uint8_t material_type, const glm::fvec3& translation) : translation(translation),
+	direction_quads(direction_quads), indirect_draws(),
+	visible_directions(get_visible_directions(Oreginum::Camera::get_position())),
+	material_type(material_type)
 {
-	//Create vertex and index buffers
+	//Each direction is drawn in batches of at most 65536 vertices
+	for(uint32_t quads : direction_quads)
+		indirect_draws += (quads+QUADS_PER_BATCH-1)/QUADS_PER_BATCH;
+
+	//Create vertex buffer
 	vertex_buffer = {Oreginum::Renderer_Core::get_device(),
 		Oreginum::Renderer_Core::get_temporary_command_buffer(),
 		vk::BufferUsageFlagBits::eVertexBuffer,
 		sizeof(float)*vertices.size(), vertices.data()};
-	index_buffer = {Oreginum::Renderer_Core::get_device(),
-		Oreginum::Renderer_Core::get_temporary_command_buffer(),
-		vk::BufferUsageFlagBits::eIndexBuffer,
-		sizeof(uint32_t)*indices.size(), indices.data()};
-	index_count = static_cast<int32_t>(indices.size());
+
+	//Create the quad index buffer shared by every render group if not already created,
+	//a single batch of quads indexes at most 65536 vertices so 16-bit indices suffice
+	if(!quad_index_buffer.get())
+	{
+		constexpr uint16_t RECTANGLE_INDICES[QUAD_INDICES]{0, 1, 2, 2, 3, 0};
+		std::vector<uint16_t> indices(QUADS_PER_BATCH*QUAD_INDICES);
+		for(uint32_t i{}; i < indices.size(); ++i) indices[i] = static_cast<uint16_t>(
+			RECTANGLE_INDICES[i%QUAD_INDICES]+i/QUAD_INDICES*QUAD_VERTICES);
+		quad_index_buffer = {Oreginum::Renderer_Core::get_device(),
+			Oreginum::Renderer_Core::get_temporary_command_buffer(),
+			vk::BufferUsageFlagBits::eIndexBuffer,
+			sizeof(uint16_t)*indices.size(), indices.data()};
+	}
 
 	//Load texture array and create sampler if not already created
 	if(texture_map.get_image().get()) return;
 	sampler = {Oreginum::Renderer_Core::get_device(), 9, true};
-	texture_map = {std::vector<std::string>{
+	const std::vector<std::string> TEXTURES{
 		"Resources/Textures/Stone.png",
 		"Resources/Textures/Dirt Specular.png",
 		"Resources/Textures/Dirt.png",
@@ -38,7 +62,23 @@ Tetra::Render_Group::Render_Group(const std::vector<float>& vertices, const std:
 		"Resources/Textures/Dirt Specular.png",
 		"Resources/Textures/Leaves.png",
 		"Resources/Textures/Dirt Specular.png",
-	}, sampler, Oreginum::Texture::LINEAR};
+	};
+
+	//The array built from these by "# Texture Compiler.bat" is loaded as is from the resource
+	//pack, or its own file, the images are only decoded when it is missing or invalid
+	Oreginum::Resource_Pack::Span texture_array{
+		Oreginum::Resource_Pack::get("Textures/Textures.array")};
+	std::unique_ptr<Oreginum::Mapped_File> texture_array_file;
+	if(!texture_array.data)
+	{
+		texture_array_file = std::make_unique<Oreginum::Mapped_File>(
+			"Resources/Textures/Textures.array");
+		texture_array = {texture_array_file->get_data(), texture_array_file->get_size()};
+	}
+	if(Oreginum::Texture_Array::is_valid(texture_array.data, texture_array.size,
+		static_cast<uint32_t>(TEXTURES.size())))
+		texture_map = {texture_array.data, texture_array.size, sampler};
+	else texture_map = {TEXTURES, sampler, Oreginum::Texture::LINEAR};
 }
 	
 void Tetra::Render_Group::initialize_descriptor()
@@ -55,11 +95,88 @@ void Tetra::Render_Group::update()
 	uniforms.projection = Oreginum::Camera::get_projection();
 	uniforms.view = Oreginum::Camera::get_view();
 	uniforms.model = glm::translate(translation);
+	visible_directions = get_visible_directions(Oreginum::Camera::get_position());
+}
+
+void Tetra::Render_Group::write_indirect_draws(vk::DrawIndexedIndirectCommand *draws) const
+{
+	//Hidden directions keep their draws with no instances, so the recorded count holds
+	uint32_t first_quad{};
+	for(uint8_t direction{}; direction < DIRECTIONS; ++direction)
+	{
+		const uint32_t INSTANCES{static_cast<uint32_t>(visible_directions>>direction&0b1)};
+		for(uint32_t quad{}; quad < direction_quads[direction]; quad += QUADS_PER_BATCH)
+			*draws++ = {std::min(direction_quads[direction]-quad, QUADS_PER_BATCH)*QUAD_INDICES,
+				INSTANCES, 0, static_cast<int32_t>((first_quad+quad)*QUAD_VERTICES), 0};
+		first_quad += direction_quads[direction];
+	}
+}
+
+uint8_t Tetra::Render_Group::get_visible_directions(const glm::fvec3& camera_position) const
+{
+	//A direction is hidden when the camera is behind every face plane it contains, the
+	//margin keeps the faces on the chunk's border planes drawn from right on them
+	constexpr float MARGIN{1.f};
+	uint8_t directions{};
+	for(uint8_t axis{}; axis < 3; ++axis)
+	{
+		if(camera_position[axis] > translation[axis]-MARGIN) directions |= 0b1<<axis*2;
+		if(camera_position[axis] < translation[axis]+CHUNK_SIZE+MARGIN)
+			directions |= 0b1<<(axis*2+1);
+	}
+	return directions;
 }
 
-void Tetra::Render_Group::draw(const Oreginum::Vulkan::Command_Buffer& command_buffer)
+uint8_t Tetra::Render_Group::get_lit_directions() const
+{
+	//The light is directional, so only faces pointing towards it reach the shadow map
+	const glm::fvec3 LIGHT_DIRECTION{Oreginum::Main_Renderer::get_light_direction()};
+	uint8_t directions{};
+	for(uint8_t axis{}; axis < 3; ++axis)
+	{
+		if(LIGHT_DIRECTION[axis] < 0) directions |= 0b1<<axis*2;
+		if(LIGHT_DIRECTION[axis] > 0) directions |= 0b1<<(axis*2+1);
+	}
+	return directions;
+}
+
+void Tetra::Render_Group::draw_range(const Oreginum::Vulkan::Command_Buffer& command_buffer,
+	uint32_t first_quad, uint32_t quad_count) const
+{
+	//Draw in batches of at most 65536 vertices, offsetting into the vertex buffer
+	for(uint32_t quad{}; quad < quad_count; quad += QUADS_PER_BATCH)
+		command_buffer.get().drawIndexed(std::min(quad_count-quad, QUADS_PER_BATCH)*
+			QUAD_INDICES, 1, 0, (first_quad+quad)*QUAD_VERTICES, 0);
+}
+
+void Tetra::Render_Group::draw(const Oreginum::Vulkan::Command_Buffer& command_buffer, bool shadow,
+	uint8_t image, uint32_t first_indirect_draw)
 {
 	command_buffer.get().bindVertexBuffers(0, vertex_buffer.get(), {0});
-	command_buffer.get().bindIndexBuffer(index_buffer.get(), 0, vk::IndexType::eUint32);
-	command_buffer.get().drawIndexed(index_count, 1, 0, 0, 0);
+	command_buffer.get().bindIndexBuffer(quad_index_buffer.get(), 0, vk::IndexType::eUint16);
+
+	//Directions visible from the camera change every frame, so they go through the indirect
+	//draws, one draw each as multiDrawIndirect is optional
+	if(!shadow)
+	{
+		for(uint32_t i{}; i < indirect_draws; ++i) command_buffer.get().drawIndexedIndirect(
+			Oreginum::Renderer_Core::get_indirect_buffer(image).get(),
+			(first_indirect_draw+i)*sizeof(vk::DrawIndexedIndirectCommand), 1,
+			sizeof(vk::DrawIndexedIndirectCommand));
+		return;
+	}
+
+	//Quads are stored grouped by direction, draw each run of adjacent lit directions at once
+	const uint8_t DIRECTIONS_MASK{get_lit_directions()};
+	uint32_t first_quad{}, quad_count{};
+	for(uint8_t direction{}; direction < DIRECTIONS; ++direction)
+	{
+		if(DIRECTIONS_MASK&(0b1<<direction)) quad_count += direction_quads[direction];
+		else
+		{
+			draw_range(command_buffer, first_quad, quad_count);
+			first_quad += quad_count+direction_quads[direction], quad_count = 0;
+		}
+	}
+	draw_range(command_buffer, first_quad, quad_count);
 }
\ No newline at end of file
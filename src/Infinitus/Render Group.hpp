@@ -1,4 +1,5 @@
 #pragma once
+#include <array>
 #include "../Oreginum/Renderable.hpp"
 #include "../Oreginum/Texture.hpp"
 
@@ -7,12 +8,20 @@ namespace Tetra
 	class Render_Group : public Oreginum::Renderable
 	{
 	public:
-		Render_Group(const std::vector<float>& vertices, const std::vector<uint32_t>& indices,
+		static constexpr uint32_t QUAD_VERTICES{4}, QUAD_INDICES{6},
+			QUADS_PER_BATCH{(UINT16_MAX+1)/QUAD_VERTICES};
+		static constexpr uint8_t DIRECTIONS{6};
+
+		Render_Group(const std::vector<float>& vertices,
+			const std::array<uint32_t, DIRECTIONS>& direction_quads,
 			uint8_t material_type, const glm::fvec3& translation);
 		void initialize_descriptor();
 		uint32_t get_images() const { return 1; }
 		void update();
-		void draw(const Oreginum::Vulkan::Command_Buffer& command_buffer);
+		void draw(const Oreginum::Vulkan::Command_Buffer& command_buffer, bool shadow,
+			uint8_t image, uint32_t first_indirect_draw);
+		uint32_t get_indirect_draws() const { return indirect_draws; }
+		void write_indirect_draws(vk::DrawIndexedIndirectCommand *draws) const;
 		void translate(const glm::fvec3& translation){ this->translation += translation; }
 
 		const Oreginum::Vulkan::Descriptor_Set& get_descriptor_set(){ return descriptor_set; }
@@ -24,11 +33,19 @@ namespace Tetra
 		static Oreginum::Vulkan::Sampler sampler;
 		static Oreginum::Vulkan::Descriptor_Set descriptor_set;
 		static Oreginum::Texture texture_map;
+		static Oreginum::Vulkan::Buffer quad_index_buffer;
 
 		glm::fvec3 translation;
-		Oreginum::Vulkan::Buffer vertex_buffer, index_buffer;
-		uint32_t index_count;
+		Oreginum::Vulkan::Buffer vertex_buffer;
+		std::array<uint32_t, DIRECTIONS> direction_quads;
+		uint32_t indirect_draws;
+		uint8_t visible_directions;
 		Uniforms uniforms;
 		uint8_t material_type;
+
+		uint8_t get_visible_directions(const glm::fvec3& camera_position) const;
+		uint8_t get_lit_directions() const;
+		void draw_range(const Oreginum::Vulkan::Command_Buffer& command_buffer,
+			uint32_t first_quad, uint32_t quad_count) const;
 	};
 }
\ No newline at end of file
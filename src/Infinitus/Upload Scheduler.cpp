@@ -0,0 +1,37 @@
+#include <algorithm>
+#include "Upload Scheduler.hpp"
+
+void Tetra::Upload_Scheduler::begin_frame(float frame_time, float target_frame_time,
+	float frame_record_seconds)
+{
+	//The renderer has just recorded again for the last frame's uploads
+	if(frame_uploads) statistics.record_seconds = record_seconds = record_seconds ?
+		record_seconds+(frame_record_seconds-record_seconds)*SMOOTHING : frame_record_seconds;
+
+	//Back off quickly when uploads cost a frame, and creep back up while they fit
+	if(frame_time > target_frame_time*FRAME_SLACK) budget = std::max(budget/2, MINIMUM_BUDGET);
+	else budget = std::min(budget+BUDGET_STEP, MAXIMUM_BUDGET);
+	spent = record_seconds, frame_uploads = 0;
+	statistics.budget = budget;
+}
+
+bool Tetra::Upload_Scheduler::can_upload(size_t bytes) const
+{
+	//The first upload of every frame is always allowed so the queue keeps moving
+	return !frame_uploads || spent+bytes*seconds_per_byte <= budget;
+}
+
+void Tetra::Upload_Scheduler::record(size_t bytes, float seconds, float latency)
+{
+	spent += seconds, ++frame_uploads;
+	if(bytes)
+	{
+		const float SECONDS_PER_BYTE{seconds/bytes};
+		seconds_per_byte = statistics.uploads ?
+			seconds_per_byte+(SECONDS_PER_BYTE-seconds_per_byte)*SMOOTHING : SECONDS_PER_BYTE;
+		statistics.bytes_per_second = seconds_per_byte ? 1/seconds_per_byte : 0;
+	}
+	statistics.latency = statistics.uploads ?
+		statistics.latency+(latency-statistics.latency)*SMOOTHING : latency;
+	++statistics.uploads, statistics.bytes += bytes;
+}
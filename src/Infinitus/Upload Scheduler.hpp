@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+namespace Tetra
+{
+	//Decides how many meshes are uploaded each frame. The frame's upload time budget grows
+	//while frames meet their target and halves when one is missed, and each upload is
+	//admitted by predicting its cost from the measured upload throughput. Uploading anything
+	//makes the renderer record its command buffers again on the next frame, so that cost is
+	//measured too and charged to every frame that uploads.
+	class Upload_Scheduler
+	{
+	public:
+		struct Statistics
+		{
+			size_t queue_depth;
+			uint64_t uploads, bytes;
+			float budget, latency, bytes_per_second, record_seconds;
+		};
+
+		void begin_frame(float frame_time, float target_frame_time, float frame_record_seconds);
+		bool can_upload(size_t bytes) const;
+		void record(size_t bytes, float seconds, float latency);
+		void set_queue_depth(size_t queue_depth){ statistics.queue_depth = queue_depth; }
+
+		const Statistics& get_statistics() const { return statistics; }
+
+	private:
+		static constexpr float MINIMUM_BUDGET{.0005f}, MAXIMUM_BUDGET{.008f},
+			BUDGET_STEP{.00025f}, FRAME_SLACK{1.1f}, SMOOTHING{.1f};
+
+		float budget{.002f}, spent{}, seconds_per_byte{}, record_seconds{};
+		uint32_t frame_uploads{};
+		Statistics statistics{};
+	};
+}
@@ -1,47 +1,60 @@
-#include "FastNoiseSIMD/FastNoiseSIMD.h"
+#include "../Oreginum/Core.hpp"
 #include "World.hpp"
+#include "Chunk View.hpp"
 #include <limits>
 #include <algorithm>
 
-Tetra::World::World() : current_player_chunk(0, 0, 0), last_player_chunk(0, 0, 0),
-	populated(false), meshed(false)
+Tetra::World::World(Persistence persistence, size_t chunk_memory_budget) :
+	current_player_chunk(0, 0, 0), last_player_chunk(0, 0, 0), persistence(persistence),
+	region_store("World", SEED), edit_journal("World"), generator(region_store.get_seed(),
+	[this](const glm::ivec3& chunk_pos){ return get_chunk_at(chunk_pos); },
+	[this](const glm::ivec3& chunk_pos, const glm::u8vec3& voxel, uint8_t material)
+	{ defer_voxel(chunk_pos, voxel, material); }), chunk_memory_budget(chunk_memory_budget)
 {
-	// Initialize threading arrays
-        for(uint8_t i = 0; i < THREADS; ++i) {
-            is_thread_busy[i] = false;
-            was_thread_launched[i] = false;
-        }
-        
+	// One mesh arena per worker, plus one for the main thread when it helps
+	mesh_arenas.resize(Oreginum::Job_System::get_worker_count()+1);
+	set_chunk_queue_views();
+
 	// Initial chunk loading around spawn point
 	// Force initial player chunk calculation
 	glm::fvec3 player_pos = Oreginum::Camera::get_position();
 	current_player_chunk = world_pos_to_chunk_pos(player_pos);
 	last_player_chunk = current_player_chunk;
+	load_center = current_player_chunk;
 	
-	// Load initial chunks around player (horizontal infinite, limited vertical)
-	const int VERTICAL_LOAD_DISTANCE = 2; // Only 5 chunks vertically
-	for(int x = current_player_chunk.x - LOAD_DISTANCE; x <= current_player_chunk.x + LOAD_DISTANCE; ++x) {
-		for(int y = current_player_chunk.y - VERTICAL_LOAD_DISTANCE; y <= current_player_chunk.y + VERTICAL_LOAD_DISTANCE; ++y) {
-			for(int z = current_player_chunk.z - LOAD_DISTANCE; z <= current_player_chunk.z + LOAD_DISTANCE; ++z) {
-				glm::ivec3 chunk_pos(x, y, z);
-				load_chunk(chunk_pos);
-			}
+	// Load initial chunks around player nearest first, those in render distance before
+	// the rest of the load area, any the memory budget leaves out are loaded as memory
+	// is freed
+	for(const bool RENDERED : {true, false})
+		for(const glm::ivec3& offset : get_load_spiral()) {
+			const glm::ivec3 chunk_pos = load_center + offset;
+			if(is_chunk_in_render_distance(chunk_pos, current_player_chunk) != RENDERED) continue;
+			if(has_chunk_memory()) load_chunk(chunk_pos);
+			else if(chunks_to_load.insert(chunk_pos).second) load_queue.push(chunk_pos);
 		}
-	}
 	
-	//Initial world creation
-	while(!populated) update();
+	//Initial world creation, the main thread works through jobs while it waits
+	while(!is_spawn_ready()){ update(); Oreginum::Job_System::help(); }
 }
 
 Tetra::World::~World()
 {
-	// Wait for all threads to finish
-        for(uint8_t i = 0; i < THREADS; ++i) {
-		if(was_thread_launched[i]) threads[i].join();
-	}
+	// Wait for all jobs to finish
+	for(const auto& job : jobs) Oreginum::Job_System::wait(job.second);
 	
-	// Clean up deletion queue
-	for(auto& d : deletion_queue) delete d.first;
+	// Save chunks generated this session
+	std::vector<Oreginum::Job_System::Handle> saves;
+	const auto SAVE = [this, &saves](Chunk *chunk)
+	{
+		if(chunk && persistence == SNAPSHOTS && chunk->is_generated() && !chunk->is_stored())
+			saves.push_back(Oreginum::Job_System::submit([this, chunk](uint8_t){ save_chunk(chunk); }));
+	};
+	for(Retired& r : retired) SAVE(r.chunk);
+	for(auto& pair : loaded_chunks) SAVE(pair.second);
+	for(const Oreginum::Job_System::Handle& save : saves) Oreginum::Job_System::wait(save);
+	
+	// Clean up retired chunks
+	for(Retired& r : retired) delete r.chunk;
 	
 	// Clean up all loaded chunks
 	std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
@@ -87,6 +100,208 @@ bool Tetra::World::is_chunk_in_load_distance(const glm::ivec3& chunk_pos, const
 	return diff.x <= LOAD_DISTANCE && diff.y <= VERTICAL_LOAD_DISTANCE && diff.z <= LOAD_DISTANCE;
 }
 
+uint8_t Tetra::World::get_chunk_lod(const glm::ivec3& chunk_pos, const glm::ivec3& player_chunk)
+{
+	glm::ivec3 diff = abs(chunk_pos - player_chunk);
+	const int DISTANCE = std::max(diff.x, std::max(diff.y, diff.z));
+	uint8_t lod = 0;
+	while(lod < Chunk::LODS-1 && DISTANCE > LOD_DISTANCES[lod]) ++lod;
+	return lod;
+}
+
+uint8_t Tetra::World::get_chunk_skirts(const glm::ivec3& chunk_pos)
+{
+	// Sides towards a neighbour in render distance meshed at another level of detail
+	constexpr glm::i8vec3 NEIGHBORS[CUBE_FACES]{{1, 0, 0}, {-1, 0, 0}, {0, 1, 0},
+		{0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+	const uint8_t LOD{get_chunk_lod(chunk_pos, current_player_chunk)};
+	uint8_t skirts{};
+	for(uint8_t face{}; face < CUBE_FACES; ++face)
+	{
+		const glm::ivec3 NEIGHBOR{chunk_pos+glm::ivec3{NEIGHBORS[face]}};
+		if(is_chunk_in_render_distance(NEIGHBOR, current_player_chunk) &&
+			get_chunk_lod(NEIGHBOR, current_player_chunk) != LOD) skirts |= 0b1<<face;
+	}
+	return skirts;
+}
+
+bool Tetra::World::refresh_chunk(const glm::ivec3& chunk_pos, Tetra::Chunk *chunk)
+{
+	// Sends an uploaded chunk back for remeshing. One generated at less detail than it is
+	// now meshed at waits to be populated again, see refine_chunks. Its mesh stays drawn
+	// until the new one is uploaded.
+	if(get_chunk_lod(chunk_pos, current_player_chunk) >= chunk->get_population_lod())
+		return chunk->transition(Chunk::UPLOADED, Chunk::PASS_2);
+	refinements.insert(chunk_pos);
+	return false;
+}
+
+bool Tetra::World::is_neighborhood_busy(const glm::ivec3& chunk_pos)
+{
+	// Neighbours write trees into the chunk in their second pass and read its voxels while
+	// meshing, retired ones until their job gets to abandon the work
+	for(int z = -1; z <= 1; ++z)
+		for(int y = -1; y <= 1; ++y)
+			for(int x = -1; x <= 1; ++x)
+			{
+				const Tetra::Chunk *neighbor{get_chunk_at(chunk_pos+glm::ivec3{x, y, z})};
+				if(!neighbor || !neighbor->is_claimed()) continue;
+				const Chunk::State STATE{neighbor->get_state()};
+				if(STATE == Chunk::PASS_1 || STATE == Chunk::PASS_2 || STATE == Chunk::CULLED)
+					return true;
+			}
+	for(const Retired& r : retired)
+		if(r.chunk && r.chunk->is_claimed() && glm::all(glm::lessThanEqual(glm::abs(
+			world_pos_to_chunk_pos(r.chunk->get_translation())-chunk_pos), glm::ivec3{1})))
+			return true;
+	return false;
+}
+
+void Tetra::World::refine_chunks()
+{
+	// Clearing a chunk to populate it again in more detail waits until it is uploaded and
+	// its neighbourhood is idle. Claims are only made on this thread, and afterwards no
+	// neighbour starts either stage as both wait on the chunk's passes. Tree voxels
+	// neighbours wrote into it were deferred, as it was not fully generated, and are
+	// replayed as it meshes.
+	for(auto refinement{refinements.begin()}; refinement != refinements.end();)
+	{
+		const glm::ivec3 CHUNK_POSITION{*refinement};
+		Tetra::Chunk *chunk{get_chunk_at(CHUNK_POSITION)};
+		if(chunk && (chunk->get_state() != Chunk::UPLOADED || chunk->is_claimed() ||
+			is_neighborhood_busy(CHUNK_POSITION)))
+		{
+			++refinement;
+			continue;
+		}
+		refinement = refinements.erase(refinement);
+		if(!chunk || !is_chunk_in_render_distance(CHUNK_POSITION, current_player_chunk))
+			continue;
+
+		// Chunks that moved back out of the finer detail meanwhile are only remeshed
+		if(get_chunk_lod(CHUNK_POSITION, current_player_chunk) >= chunk->get_population_lod())
+		{
+			if(refresh_chunk(CHUNK_POSITION, chunk)) queue_chunk(CHUNK_POSITION);
+		}
+		else if(chunk->transition(Chunk::UPLOADED, Chunk::ALLOCATED))
+		{
+			refining_chunks.insert(CHUNK_POSITION);
+			queue_chunk(CHUNK_POSITION);
+		}
+	}
+}
+
+void Tetra::World::update_chunk_lods(const glm::ivec3& previous_player_chunk)
+{
+	// Send uploaded chunks whose level of detail or skirts changed back for remeshing,
+	// chunks still waiting in the add queue keep their mesh until it has been uploaded.
+	// Past the last level of detail distance from both the old and new player chunk a
+	// chunk is at the lowest detail either way, and one further has no skirts, so only
+	// those two boxes are visited.
+	const int VERTICAL_RENDER_DISTANCE = 2;
+	const int LOD_DISTANCE = LOD_DISTANCES[Chunk::LODS-2]+1;
+	const glm::ivec3 EXTENT{LOD_DISTANCE, std::min(LOD_DISTANCE, VERTICAL_RENDER_DISTANCE),
+		LOD_DISTANCE};
+	std::vector<glm::ivec3> chunk_positions;
+	for(int x = -EXTENT.x; x <= EXTENT.x; ++x)
+		for(int y = -EXTENT.y; y <= EXTENT.y; ++y)
+			for(int z = -EXTENT.z; z <= EXTENT.z; ++z)
+				chunk_positions.push_back(current_player_chunk+glm::ivec3{x, y, z});
+	get_area_difference(previous_player_chunk, current_player_chunk, EXTENT, &chunk_positions);
+
+	std::vector<glm::ivec3> remeshed;
+	{
+		std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
+		for(const glm::ivec3& chunk_pos : chunk_positions) {
+			const auto chunk = loaded_chunks.find(chunk_pos);
+			if(chunk == loaded_chunks.end() || chunk->second->get_state() != Chunk::UPLOADED ||
+				!is_chunk_in_render_distance(chunk_pos, current_player_chunk)) continue;
+			if(chunk->second->get_lod() == get_chunk_lod(chunk_pos, current_player_chunk) &&
+				chunk->second->get_skirts() == get_chunk_skirts(chunk_pos)) continue;
+			if(refresh_chunk(chunk_pos, chunk->second)) remeshed.push_back(chunk_pos);
+		}
+	}
+	for(const glm::ivec3& chunk_pos : remeshed) queue_chunk(chunk_pos);
+}
+
+void Tetra::World::get_area_difference(const glm::ivec3& center, const glm::ivec3& other_center,
+	const glm::ivec3& extent, std::vector<glm::ivec3> *chunk_positions)
+{
+	// Appends the chunks of the box around center that are outside the box around
+	// other_center. Each axis adds the slabs past the other box along it, limited on
+	// the axes before it to the overlap so no chunk is added twice.
+	const glm::ivec3 MINIMUM{center-extent}, MAXIMUM{center+extent},
+		OTHER_MINIMUM{other_center-extent}, OTHER_MAXIMUM{other_center+extent};
+	for(uint8_t axis{}; axis < 3; ++axis)
+	{
+		glm::ivec3 minimum{MINIMUM}, maximum{MAXIMUM};
+		for(uint8_t a{}; a < axis; ++a) minimum[a] = std::max(MINIMUM[a], OTHER_MINIMUM[a]),
+			maximum[a] = std::min(MAXIMUM[a], OTHER_MAXIMUM[a]);
+
+		const std::array<glm::ivec2, 2> SLABS{glm::ivec2{MINIMUM[axis],
+			std::min(MAXIMUM[axis], OTHER_MINIMUM[axis]-1)}, glm::ivec2{std::max(
+			MINIMUM[axis], OTHER_MAXIMUM[axis]+1), MAXIMUM[axis]}};
+		for(const glm::ivec2& slab : SLABS)
+		{
+			minimum[axis] = slab.x, maximum[axis] = slab.y;
+			for(int x = minimum.x; x <= maximum.x; ++x)
+				for(int y = minimum.y; y <= maximum.y; ++y)
+					for(int z = minimum.z; z <= maximum.z; ++z)
+						chunk_positions->push_back({x, y, z});
+		}
+	}
+}
+
+size_t Tetra::World::move_load_area(const glm::ivec3& center)
+{
+	// Chunks entering the load area are queued for loading closest first, and those
+	// leaving it for unloading farthest first
+	const int VERTICAL_LOAD_DISTANCE = 2; // Only 5 chunks vertically (2 above, current, 2 below)
+	const glm::ivec3 EXTENT{LOAD_DISTANCE, VERTICAL_LOAD_DISTANCE, LOAD_DISTANCE};
+	std::vector<glm::ivec3> entering, leaving;
+	get_area_difference(center, load_center, EXTENT, &entering);
+	get_area_difference(load_center, center, EXTENT, &leaving);
+	load_center = center;
+
+	{
+		std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
+		for(const glm::ivec3& chunk_pos : entering)
+			if(!loaded_chunks.count(chunk_pos) && chunks_to_load.insert(chunk_pos).second)
+				load_queue.push(chunk_pos);
+	}
+
+	chunks_to_unload.insert(chunks_to_unload.end(), leaving.begin(), leaving.end());
+	const auto DISTANCE = [this](const glm::ivec3& chunk_pos)
+	{
+		const glm::ivec3 OFFSET{chunk_pos-load_center};
+		return OFFSET.x*OFFSET.x+OFFSET.y*OFFSET.y+OFFSET.z*OFFSET.z;
+	};
+	std::sort(chunks_to_unload.begin(), chunks_to_unload.end(),
+		[&DISTANCE](const glm::ivec3& a, const glm::ivec3& b){ return DISTANCE(a) < DISTANCE(b); });
+	return entering.size()+leaving.size();
+}
+
+size_t Tetra::World::move_render_area()
+{
+	// Entering or leaving render distance changes whether a chunk, and so its
+	// neighbours, may run their stages, so those neighbourhoods are queued again
+	const int VERTICAL_RENDER_DISTANCE = 2;
+	const glm::ivec3 EXTENT{RENDER_DISTANCE, VERTICAL_RENDER_DISTANCE, RENDER_DISTANCE};
+	std::vector<glm::ivec3> changed;
+	get_area_difference(current_player_chunk, last_player_chunk, EXTENT, &changed);
+	get_area_difference(last_player_chunk, current_player_chunk, EXTENT, &changed);
+	update_chunk_lods(last_player_chunk);
+	last_player_chunk = current_player_chunk;
+
+	std::unordered_set<glm::ivec3, ivec3_hash> neighbourhoods;
+	for(const glm::ivec3& chunk_pos : changed)
+		for(int z = -1; z <= 1; ++z)
+			for(int y = -1; y <= 1; ++y)
+				for(int x = -1; x <= 1; ++x) neighbourhoods.insert(chunk_pos+glm::ivec3{x, y, z});
+	for(const glm::ivec3& chunk_pos : neighbourhoods) queue_chunk(chunk_pos);
+	return changed.size();
+}
+
 void Tetra::World::load_chunk(const glm::ivec3& chunk_pos)
 {
 	if(is_chunk_loaded(chunk_pos)) return;
@@ -95,12 +310,14 @@ void Tetra::World::load_chunk(const glm::ivec3& chunk_pos)
 	glm::fvec3 world_translation = glm::fvec3(chunk_pos) * static_cast<float>(CHUNK_SIZE);
 	Tetra::Chunk* new_chunk = new Tetra::Chunk(world_translation, glm::fvec3(0), 
 		glm::u8vec3(chunk_pos.x & 255, chunk_pos.y & 255, chunk_pos.z & 255));
+	new_chunk->set_stored(persistence == SNAPSHOTS && region_store.contains(chunk_pos));
 	
 	// Add to loaded chunks
 	{
 		std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
 		loaded_chunks[chunk_pos] = new_chunk;
 	}
+	queue_chunk(chunk_pos);
 }
 
 void Tetra::World::unload_chunk(const glm::ivec3& chunk_pos)
@@ -111,18 +328,74 @@ void Tetra::World::unload_chunk(const glm::ivec3& chunk_pos)
 	// Remove render groups immediately
                 chunk->remove_render_groups();
                 
-	// Add to deletion queue
-	{
-		std::lock_guard<std::mutex> deletion_queue_guard{deletion_queue_mutex};
-		chunk->set_being_deleted(true);
-		deletion_queue.emplace_back(chunk, 0);
-	}
-	
-	// Remove from loaded chunks
+	// Remove from loaded chunks, then retire it so running jobs cancel
 	{
 		std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
 		loaded_chunks.erase(chunk_pos);
 	}
+	refinements.erase(chunk_pos), refining_chunks.erase(chunk_pos);
+	chunk->retire();
+	retire(chunk, {});
+}
+
+void Tetra::World::set_voxel(const glm::ivec3& position, uint8_t material)
+{
+	const glm::ivec3 CHUNK_POSITION{world_pos_to_chunk_pos(glm::fvec3(position))};
+	const glm::ivec3 VOXEL{position-CHUNK_POSITION*static_cast<int>(CHUNK_SIZE)};
+	edit_journal.record(CHUNK_POSITION, (VOXEL.z*CHUNK_SIZE+VOXEL.y)*CHUNK_SIZE+VOXEL.x, material);
+
+	// Idle chunks are remeshed, along with neighbours whose culling and occlusion look
+	// across the voxel's border. Chunks in flight replay the edit when they mesh, or are
+	// sent back at upload when they meshed before it.
+	for(int z = -1; z <= 1; ++z)
+		for(int y = -1; y <= 1; ++y)
+			for(int x = -1; x <= 1; ++x)
+			{
+				const glm::ivec3 OFFSET{x, y, z};
+				bool borders{true};
+				for(uint8_t axis{}; axis < 3; ++axis)
+					if((OFFSET[axis] < 0 && VOXEL[axis] != 0) ||
+						(OFFSET[axis] > 0 && VOXEL[axis] != CHUNK_SIZE-1)) borders = false;
+				Chunk *chunk{borders ? get_chunk_at(CHUNK_POSITION+OFFSET) : nullptr};
+				if(chunk && chunk->transition(Chunk::UPLOADED, Chunk::PASS_2))
+					queue_chunk(CHUNK_POSITION+OFFSET);
+			}
+}
+
+bool Tetra::World::raycast(const glm::fvec3& origin, const glm::fvec3& direction,
+	float distance, glm::ivec3 *hit, glm::ivec3 *previous)
+{
+	// Steps voxel by voxel along the ray, through each axis' next voxel border in turn,
+	// until an opaque voxel of a meshed chunk. Unmeshed chunks stop the ray.
+	glm::ivec3 voxel{glm::floor(origin)}, step;
+	glm::fvec3 next, delta;
+	for(uint8_t axis{}; axis < 3; ++axis)
+	{
+		step[axis] = direction[axis] < 0 ? -1 : 1;
+		delta[axis] = direction[axis] ? std::abs(1/direction[axis]) :
+			std::numeric_limits<float>::infinity();
+		next[axis] = direction[axis] ? (voxel[axis]+(step[axis] > 0)-origin[axis])/
+			direction[axis] : std::numeric_limits<float>::infinity();
+	}
+	*previous = voxel;
+	for(float travelled{}; travelled <= distance;)
+	{
+		const glm::ivec3 CHUNK_POSITION{world_pos_to_chunk_pos(glm::fvec3(voxel))};
+		const Chunk *CHUNK{get_chunk_at(CHUNK_POSITION)};
+		if(!CHUNK || !CHUNK->is_meshed()) return false;
+		if(!CHUNK->is_voxel_transparent(glm::u8vec3(voxel-CHUNK_POSITION*static_cast<int>(CHUNK_SIZE))))
+		{
+			*hit = voxel;
+			return true;
+		}
+
+		const uint8_t AXIS{static_cast<uint8_t>(next.x < next.y ? (next.x < next.z ? 0 : 2) :
+			(next.y < next.z ? 1 : 2))};
+		*previous = voxel;
+		voxel[AXIS] += step[AXIS];
+		travelled = next[AXIS], next[AXIS] += delta[AXIS];
+	}
+	return false;
 }
 
 void Tetra::World::update_chunks_around_player()
@@ -130,498 +403,528 @@ void Tetra::World::update_chunks_around_player()
 	// Get player position from camera
 	glm::fvec3 player_pos = Oreginum::Camera::get_position();
 	current_player_chunk = world_pos_to_chunk_pos(player_pos);
+	const glm::ivec3 LOAD_CENTER{get_load_center()};
 	
-	// Check if player moved to a different chunk
-	if(current_player_chunk != last_player_chunk)
+	// On a crossing only the slabs the load and render areas gained or lost are visited
+	if(current_player_chunk != last_player_chunk || LOAD_CENTER != load_center)
 	{
-		// Determine chunks to load (horizontal infinite, limited vertical like Minecraft)
-		const int VERTICAL_LOAD_DISTANCE = 2; // Only 5 chunks vertically (2 above, current, 2 below)
-		for(int x = current_player_chunk.x - LOAD_DISTANCE; x <= current_player_chunk.x + LOAD_DISTANCE; ++x) {
-			for(int y = current_player_chunk.y - VERTICAL_LOAD_DISTANCE; y <= current_player_chunk.y + VERTICAL_LOAD_DISTANCE; ++y) {
-				for(int z = current_player_chunk.z - LOAD_DISTANCE; z <= current_player_chunk.z + LOAD_DISTANCE; ++z) {
-					glm::ivec3 chunk_pos(x, y, z);
-					if(!is_chunk_loaded(chunk_pos)) {
-						chunks_to_load.insert(chunk_pos);
-					}
-				}
-			}
-		}
-		
-		// Determine chunks to unload (outside LOAD_DISTANCE)
-		std::vector<glm::ivec3> chunks_to_remove;
-		{
-			std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
-			for(const auto& pair : loaded_chunks) {
-				if(!is_chunk_in_load_distance(pair.first, current_player_chunk)) {
-					chunks_to_remove.push_back(pair.first);
-				}
-			}
-		}
-		
-		// Queue chunks for unloading
-		for(const glm::ivec3& chunk_pos : chunks_to_remove) {
-			chunks_to_unload.insert(chunk_pos);
-		}
-		
-		last_player_chunk = current_player_chunk;
+		const std::chrono::steady_clock::time_point START{std::chrono::steady_clock::now()};
+		set_chunk_queue_views();
+		size_t chunks{};
+		if(LOAD_CENTER != load_center) chunks += move_load_area(LOAD_CENTER);
+		if(current_player_chunk != last_player_chunk) chunks += move_render_area();
+
+		const float SECONDS{std::chrono::duration<float>(
+			std::chrono::steady_clock::now()-START).count()};
+		++crossing_statistics.crossings, crossing_statistics.chunks = chunks;
+		crossing_statistics.seconds = SECONDS;
+		crossing_statistics.maximum_seconds = std::max(crossing_statistics.maximum_seconds, SECONDS);
 	}
+	else if(glm::dot(Oreginum::Camera::get_direction(),
+		chunk_queues[MESHING].get_view_direction()) < REKEY_VIEW_COSINE ||
+		glm::length(get_predicted_position()-chunk_queues[MESHING].get_view_position()) >
+		REKEY_DISTANCE) set_chunk_queue_views();
 	
-	// Process chunk loading (limit per frame to avoid hitches)
-	const int MAX_LOADS_PER_FRAME = 2;
-	int loads_this_frame = 0;
-	auto load_it = chunks_to_load.begin();
-	while(load_it != chunks_to_load.end() && loads_this_frame < MAX_LOADS_PER_FRAME) {
-		load_chunk(*load_it);
-		load_it = chunks_to_load.erase(load_it);
-		++loads_this_frame;
+	// Process chunk unloading, farthest first, chunks the load area has since moved
+	// back over are kept. Unloading waits while saves are backlogged, so memory held
+	// by unsaved chunks stays bounded and loading waits on the memory budget in turn.
+	const int MAX_UNLOADS_PER_FRAME = 5;
+	const bool SAVES_BACKLOGGED{persistence == SNAPSHOTS && region_store.is_backlogged()};
+	for(int unloads_this_frame = 0; !SAVES_BACKLOGGED && unloads_this_frame <
+		MAX_UNLOADS_PER_FRAME && !chunks_to_unload.empty(); ++unloads_this_frame) {
+		const glm::ivec3 unload_pos{chunks_to_unload.back()};
+		chunks_to_unload.pop_back();
+		if(!is_chunk_in_load_distance(unload_pos, load_center)) unload_chunk(unload_pos);
 	}
 	
-	// Process chunk unloading
-	const int MAX_UNLOADS_PER_FRAME = 5;
-	int unloads_this_frame = 0;
-	auto unload_it = chunks_to_unload.begin();
-	while(unload_it != chunks_to_unload.end() && unloads_this_frame < MAX_UNLOADS_PER_FRAME) {
-		unload_chunk(*unload_it);
-		unload_it = chunks_to_unload.erase(unload_it);
-		++unloads_this_frame;
+	// Process chunk loading, closest to where the player is heading first (limit per
+	// frame to avoid hitches), for as long as the memory budget allows. Chunks the load
+	// area has since moved away from are skipped. A chunk in render distance left
+	// waiting on memory evicts a prefetched one, unless retired chunks are about to
+	// free memory anyway.
+	const int MAX_LOADS_PER_FRAME = 4;
+	int loads_this_frame = 0;
+	glm::ivec3 load_pos;
+	while(loads_this_frame < MAX_LOADS_PER_FRAME && load_queue.pop(&load_pos)) {
+		if(!chunks_to_load.count(load_pos) || !is_chunk_in_load_distance(load_pos, load_center)) {
+			chunks_to_load.erase(load_pos);
+			continue;
+		}
+		if(!has_chunk_memory()) {
+			if(!retired_chunks && !SAVES_BACKLOGGED &&
+				is_chunk_in_render_distance(load_pos, current_player_chunk)) evict_prefetched_chunk();
+			load_queue.push(load_pos);
+			break;
+		}
+		chunks_to_load.erase(load_pos);
+		load_chunk(load_pos);
+		++loads_this_frame;
 	}
 }
 
-void Tetra::World::population_pass_1(Tetra::Chunk *chunk, uint8_t thread_index)
-{
-	populate_chunk_pass_1(chunk);
+void Tetra::World::save_chunk(Tetra::Chunk *chunk)
+{ region_store.write(world_pos_to_chunk_pos(chunk->get_translation()), chunk->encode()); }
 
-	chunk->set_populated(0, true);
-	chunk->set_being_created(false);
+void Tetra::World::population_pass_1(Tetra::Chunk *chunk, uint8_t lod)
+{
+	// Work on chunks retired while queued or running is abandoned,
+	// advancing still releases the claim so they can be deleted.
+	// Stored chunks are decoded into the chunk through a view of the mapped region, and
+	// generated at the given detail if that fails.
+	// The region's edit journal is read here too, so the main thread looking up edit
+	// revisions at upload never waits on the disk.
+	if(!chunk->is_retiring())
+	{
+		edit_journal.load(world_pos_to_chunk_pos(chunk->get_translation()));
+		if(chunk->is_stored() && !region_store.read(world_pos_to_chunk_pos(
+			chunk->get_translation()), [chunk](const uint8_t *data, size_t size)
+			{ return chunk->decode(Chunk_View{data, size}); })) chunk->set_stored(false);
+		if(!chunk->is_stored()) generator.populate_chunk_pass_1(chunk, lod);
+	}
 
-	is_thread_busy[thread_index] = false;
+	if(chunk->advance(Chunk::PASS_1)) complete_chunk(chunk);
 }
 
-void Tetra::World::population_pass_2(Tetra::Chunk *chunk, uint8_t thread_index)
+void Tetra::World::population_pass_2(Tetra::Chunk *chunk)
 {
-	populate_chunk_pass_2(chunk);
+	if(!chunk->is_retiring() && !chunk->is_stored() && generator.populate_chunk_pass_2(chunk) &&
+		!chunk->get_population_lod()) chunk->set_generated(true);
 
 	// For infinite world, we only set this specific chunk as populated
-	chunk->set_populated(1, true);
-	chunk->set_being_created(false);
+	if(chunk->advance(Chunk::PASS_2)) complete_chunk(chunk);
+}
+
+void Tetra::World::defer_voxel(const glm::ivec3& chunk_pos, const glm::u8vec3& voxel,
+	uint8_t material)
+{
+	// Tree voxels a chunk may not keep are journaled beneath any edit of the voxel, and
+	// replayed over it as it meshes. Both persistences journal them, so a regenerated
+	// chunk gets the same trees whichever order it and its neighbours load in, and edits
+	// replay over the same baseline. One already meshed is sent back once it is found.
+	if(!edit_journal.record(chunk_pos,
+		(voxel.z*CHUNK_SIZE+voxel.y)*CHUNK_SIZE+voxel.x, material, false)) return;
+	std::lock_guard<std::mutex> completions_guard{completions_mutex};
+	deferred_chunks.push_back(chunk_pos);
+}
 
-	is_thread_busy[thread_index] = false;
+void Tetra::World::apply_edits(Tetra::Chunk *chunk)
+{
+	std::vector<Edit_Journal::Edit> edits;
+	chunk->set_edit_revision(edit_journal.get_edits(
+		world_pos_to_chunk_pos(chunk->get_translation()), &edits));
+	for(const Edit_Journal::Edit& e : edits)
+		chunk->set_voxel_material(glm::u8vec3(e.voxel%CHUNK_SIZE, e.voxel/CHUNK_SIZE%CHUNK_SIZE,
+			e.voxel/(CHUNK_SIZE*CHUNK_SIZE)), e.material);
 }
 
-void Tetra::World::mesh_chunk(Tetra::Chunk *chunk, uint8_t thread_index)
+void Tetra::World::mesh_chunk(Tetra::Chunk *chunk, uint8_t worker_index, uint8_t lod,
+	uint8_t skirts)
 {
-	//Cull, and mesh
-	cull_chunk(chunk);
-	chunk->create_mesh();
+	//Edits are replayed last, once neighbours have written their trees into the chunk
+	if(!chunk->is_retiring()) apply_edits(chunk);
+
+	//Cull, and mesh, lower levels of detail cull their own downsampled grid against the
+	//neighbours' and only full detail meshes look into neighbours for ambient occlusion
+	const glm::ivec3 CHUNK_POSITION{world_pos_to_chunk_pos(chunk->get_translation())};
+	Chunk_Neighborhood neighborhood{};
+	if(!chunk->is_retiring())
+	{
+		for(int z = -1; z <= 1; ++z)
+			for(int y = -1; y <= 1; ++y)
+				for(int x = -1; x <= 1; ++x)
+					neighborhood[(z+1)*9+(y+1)*3+x+1] =
+						get_chunk_at(CHUNK_POSITION+glm::ivec3{x, y, z});
+	}
+
+	//A chunk whose contents and borders are unchanged since a cached mesh was built
+	//takes that mesh and skips culling and meshing
+	const Mesh_Cache::Key MESH_KEY{CHUNK_POSITION, chunk->get_edit_revision(),
+		chunk->is_retiring() ? 0 : chunk->get_mesh_key(lod, &neighborhood, skirts), lod, skirts};
+	const bool CACHED{!chunk->is_retiring() && mesh_cache.get(MESH_KEY, chunk)};
+	if(!CACHED && !lod && !chunk->is_retiring()) cull_chunk(chunk, skirts);
+	if(!chunk->advance(Chunk::CULLED, false) || (!CACHED &&
+		!chunk->create_mesh(&mesh_arenas[worker_index], lod, &neighborhood, skirts)))
+	{
+		chunk->advance(Chunk::MESHED);
+		return;
+	}
+	if(!CACHED && !chunk->is_retiring()) mesh_cache.put(MESH_KEY, *chunk);
 
 	//Emplace in add queue
 	{
 		std::lock_guard<std::mutex> guard{add_queue_mutex};
-		add_queue.emplace_back(chunk);
+		add_queue.emplace_back(CHUNK_POSITION, std::chrono::steady_clock::now());
 	}
 
-	chunk->set_meshed(true);
-	chunk->set_being_created(false);
-	is_thread_busy[thread_index] = false;
+	chunk->advance(Chunk::MESHED);
 }
 
-Tetra::Chunk *Tetra::World::get_population_pass_1_chunk()
+uint8_t Tetra::World::get_chunk_stage(Tetra::Chunk *chunk)
 {
-	std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
-	
-	// Only process chunks in render distance
-	for(const auto& pair : loaded_chunks) {
-		if(is_chunk_in_render_distance(pair.first, current_player_chunk)) {
-			Tetra::Chunk* chunk = pair.second;
-			if(!chunk->is_populated(0) && !chunk->is_being_created()) {
-				return chunk;
-			}
-		}
+	// Each stage takes chunks in the state of the same value
+	switch(chunk->get_state())
+	{
+	case Chunk::ALLOCATED: return POPULATION_PASS_1;
+	case Chunk::PASS_1: return POPULATION_PASS_2;
+	case Chunk::PASS_2: return MESHING;
+	default: return STAGES;
 	}
-	return nullptr;
 }
 
-Tetra::Chunk *Tetra::World::get_population_pass_2_chunk()
+bool Tetra::World::is_dependency_met(const glm::ivec3& chunk_pos, Chunk::State state)
 {
-	std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
-	
-	// Only process chunks in render distance
-	for(const auto& pair : loaded_chunks) {
-		if(is_chunk_in_render_distance(pair.first, current_player_chunk)) {
-			Tetra::Chunk* chunk = pair.second;
-			if(!chunk->is_populated(1) && !chunk->is_being_created() && chunk->is_populated(0)) {
-				return chunk;
-			}
-		}
-	}
-	return nullptr;
+	// Chunks outside render distance never run their stages, so nothing waits on them
+	Tetra::Chunk* chunk = get_chunk_at(chunk_pos);
+	return !chunk || !is_chunk_in_render_distance(chunk_pos, current_player_chunk) ||
+		chunk->get_state() >= state;
 }
 
-Tetra::Chunk *Tetra::World::get_unmeshed_chunk()
+bool Tetra::World::is_chunk_ready(const glm::ivec3& chunk_pos, uint8_t stage)
 {
-	std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
-	
-	// Get closest chunk that is unmeshed within render distance
-	Tetra::Chunk *result = nullptr;
-	float closest_distance = std::numeric_limits<float>::max();
-	
-	for(const auto& pair : loaded_chunks) {
-		if(is_chunk_in_render_distance(pair.first, current_player_chunk)) {
-			Tetra::Chunk* chunk = pair.second;
-			if(!chunk->is_meshed() && !chunk->is_being_created() && 
-			   chunk->is_populated(0) && chunk->is_populated(1)) {
-				
-				// Calculate distance from player
-				glm::fvec3 chunk_center = glm::fvec3(pair.first) * static_cast<float>(CHUNK_SIZE) + 
-					glm::fvec3(CHUNK_SIZE/2);
-				glm::fvec3 player_pos = Oreginum::Camera::get_position();
-				float distance = glm::length(chunk_center - player_pos);
-				
-				if(distance < closest_distance) {
-					closest_distance = distance;
-					result = chunk;
-				}
-			}
-		}
+	// Second pass population writes trees up to one chunk sideways and upwards, so it
+	// waits on the first pass of those chunks, meshing reads and is written into by
+	// every neighbour so it waits on their second pass
+	switch(stage)
+	{
+	case POPULATION_PASS_2:
+		for(int z = -1; z <= 1; ++z)
+			for(int y = -1; y <= 0; ++y)
+				for(int x = -1; x <= 1; ++x)
+					if(!is_dependency_met(chunk_pos+glm::ivec3{x, y, z}, Chunk::PASS_1))
+						return false;
+		return true;
+	case MESHING:
+		for(int z = -1; z <= 1; ++z)
+			for(int y = -1; y <= 1; ++y)
+				for(int x = -1; x <= 1; ++x)
+					if(!is_dependency_met(chunk_pos+glm::ivec3{x, y, z}, Chunk::PASS_2))
+						return false;
+		return true;
+	default: return true;
 	}
-	
-	return result;
 }
 
-int8_t Tetra::World::get_thread()
+void Tetra::World::queue_chunk(const glm::ivec3& chunk_pos)
 {
-	//Get thread
-	int8_t thread_index{-1};
-	for(uint8_t j{}; j < THREADS; ++j) if(!is_thread_busy[j]) thread_index = j;
-	if(thread_index == -1) return -1;
+	Tetra::Chunk* chunk = get_chunk_at(chunk_pos);
+	if(!chunk || chunk->is_claimed() ||
+		!is_chunk_in_render_distance(chunk_pos, current_player_chunk)) return;
 
-	//Check and prepare chunk
-	is_thread_busy[thread_index] = true;
-	if(was_thread_launched[thread_index]) threads[thread_index].join();
-	else was_thread_launched[thread_index] = true;
-	return thread_index;
+	const uint8_t STAGE{get_chunk_stage(chunk)};
+	if(STAGE != STAGES && is_chunk_ready(chunk_pos, STAGE)) chunk_queues[STAGE].push(chunk_pos);
 }
 
-void Tetra::World::update()
+void Tetra::World::complete_chunk(Tetra::Chunk *chunk)
 {
-	// Update chunks around player first
-	update_chunks_around_player();
-	
-	//Wait 3 frames to ensure buffers aren't in use, then delete enqueued chunks
-	if(deletion_queue.size())
+	std::lock_guard<std::mutex> completions_guard{completions_mutex};
+	completions.push_back(world_pos_to_chunk_pos(chunk->get_translation()));
+}
+
+void Tetra::World::process_completions()
+{
+	// A finished stage can make the chunk and any of its neighbours ready
+	std::vector<glm::ivec3> completed, deferred;
 	{
-		std::lock_guard<std::mutex> deletion_queue_guard{deletion_queue_mutex};
-		std::lock_guard<std::mutex> render_guard{
-			*Oreginum::Renderer_Core::get_render_mutex()};
-		for(uint32_t i{}; i < deletion_queue.size(); ++i)
-		{
-			if(deletion_queue[i].second > 5)
-			{
-				if(!deletion_queue[i].first->is_being_created())
-				{
-					for(uint32_t j{}; j < add_queue.size(); ++j)
-						if(add_queue[j] == deletion_queue[i].first)
-							add_queue.erase(add_queue.begin()+j);
-					delete deletion_queue[i].first;
-					deletion_queue.erase(deletion_queue.begin()+i);
-				}
-			} else ++deletion_queue[i].second;
-		}
+		std::lock_guard<std::mutex> completions_guard{completions_mutex};
+		completed.swap(completions), deferred.swap(deferred_chunks);
 	}
 
-	//Create chunk render groups
-	for(uint8_t i{}; i < CHUNKS_ADDED_PER_FRAME; ++i)
+	// Chunks given tree voxels after they were meshed are remeshed, those still in
+	// flight are caught by their edit revision at upload
+	for(const glm::ivec3& chunk_pos : deferred)
 	{
-		if(add_queue.size())
-		{
-			if(!add_queue.front()->is_being_deleted()) 
-			{
-				add_queue.front()->create_render_groups();
-				add_queue.front()->add_render_groups();
-			}
-			add_queue.erase(add_queue.begin());
-		} else break;
+		Tetra::Chunk *chunk{get_chunk_at(chunk_pos)};
+		if(chunk && refresh_chunk(chunk_pos, chunk)) queue_chunk(chunk_pos);
 	}
-
-	//First pass population
-	Tetra::Chunk *population_pass_1_chunk{nullptr};
-	while(true)
+	for(const glm::ivec3& chunk_pos : completed)
 	{
-		population_pass_1_chunk = get_population_pass_1_chunk();
-		if(!population_pass_1_chunk) break;
-
-		int8_t thread_index{get_thread()};
-		if(thread_index == -1) break;
-
-		population_pass_1_chunk->set_being_created(true);
-		threads[thread_index] = std::thread{&World::population_pass_1,
-			this, population_pass_1_chunk, thread_index};
+		// Chunks populated again in more detail have rewritten the voxels their
+		// neighbours culled against and written trees into them, so those are remeshed
+		Tetra::Chunk *chunk{refining_chunks.count(chunk_pos) ? get_chunk_at(chunk_pos) : nullptr};
+		if(chunk && chunk->get_state() >= Chunk::PASS_2)
+		{
+			refining_chunks.erase(chunk_pos);
+			for(int z = -1; z <= 1; ++z)
+				for(int y = -1; y <= 1; ++y)
+					for(int x = -1; x <= 1; ++x)
+					{
+						Tetra::Chunk *neighbor{get_chunk_at(chunk_pos+glm::ivec3{x, y, z})};
+						if(neighbor && neighbor != chunk)
+							refresh_chunk(chunk_pos+glm::ivec3{x, y, z}, neighbor);
+					}
+		}
+		for(int z = -1; z <= 1; ++z)
+			for(int y = -1; y <= 1; ++y)
+				for(int x = -1; x <= 1; ++x) queue_chunk(chunk_pos+glm::ivec3{x, y, z});
 	}
+	// Neighbourhoods that finished their stages may now let waiting chunks be refined
+	refine_chunks();
+}
 
-	//If first pass population has completed, do second population pass
-	Tetra::Chunk *population_pass_2_chunk{nullptr};
-	while(!population_pass_1_chunk)
+Tetra::Chunk *Tetra::World::pop_chunk(uint8_t stage)
+{
+	// Entries are validated here rather than removed when chunks change, stale ones
+	// are dropped and come back when a neighbour completes or the render area moves.
+	// The returned chunk is claimed for the stage.
+	glm::ivec3 chunk_pos;
+	while(chunk_queues[stage].pop(&chunk_pos))
 	{
-		population_pass_2_chunk = get_population_pass_2_chunk();
-		if(!population_pass_2_chunk) break;
-
-		int8_t thread_index{get_thread()};
-		if(thread_index == -1) break;
-
-		population_pass_2_chunk->set_being_created(true);
-		threads[thread_index] = std::thread{&World::population_pass_2,
-			this, population_pass_2_chunk, thread_index};
+		Tetra::Chunk* chunk = get_chunk_at(chunk_pos);
+		if(chunk && is_chunk_in_render_distance(chunk_pos, current_player_chunk) &&
+			get_chunk_stage(chunk) == stage && is_chunk_ready(chunk_pos, stage) &&
+			chunk->claim(static_cast<Chunk::State>(stage))) return chunk;
 	}
+	return nullptr;
+}
 
-	populated = !population_pass_1_chunk && !population_pass_2_chunk;
+bool Tetra::World::has_chunk_memory()
+{
+	// Only the main thread adds or removes chunks, so the count can be read unlocked
+	return (loaded_chunks.size()+retired_chunks+1)*sizeof(Chunk) <= chunk_memory_budget;
+}
 
-	//If population has completed, cull and mesh unmeshed
-	//chunks, then add them to the add queue
-	Tetra::Chunk *unmeshed_chunk{nullptr};
-	while(populated)
+bool Tetra::World::evict_prefetched_chunk()
+{
+	// The loaded chunk outside render distance farthest from the player is unloaded, and
+	// loads again once memory allows if it is still in the load area
+	glm::ivec3 farthest;
+	int farthest_distance{-1};
+	for(const auto& loaded : loaded_chunks)
 	{
-		unmeshed_chunk = get_unmeshed_chunk();
-		if(!unmeshed_chunk) break;
-
-		int8_t thread_index{get_thread()};
-		if(thread_index == -1) break;
-
-		unmeshed_chunk->set_being_created(true);
-		threads[thread_index] = std::thread{&World::mesh_chunk,
-			this, unmeshed_chunk, thread_index};
+		if(is_chunk_in_render_distance(loaded.first, current_player_chunk)) continue;
+		const glm::ivec3 OFFSET{loaded.first-current_player_chunk};
+		const int DISTANCE{OFFSET.x*OFFSET.x+OFFSET.y*OFFSET.y+OFFSET.z*OFFSET.z};
+		if(DISTANCE > farthest_distance) farthest = loaded.first, farthest_distance = DISTANCE;
 	}
+	if(farthest_distance < 0) return false;
 
-	meshed = !unmeshed_chunk;
+	unload_chunk(farthest);
+	if(is_chunk_in_load_distance(farthest, load_center) && chunks_to_load.insert(farthest).second)
+		load_queue.push(farthest);
+	return true;
 }
 
-float *Tetra::World::simplex(const glm::ivec3& offset, const glm::ivec3& size,
-	float frequency, uint32_t octaves, uint32_t seed)
+const std::vector<glm::ivec3>& Tetra::World::get_load_spiral()
 {
-	FastNoiseSIMD *generator{FastNoiseSIMD::NewFastNoiseSIMD(seed)};
-	generator->SetFrequency(frequency);
-	generator->SetFractalOctaves(octaves);
-	return generator->GetSimplexFractalSet(offset.x,
-		offset.y, offset.z, size.x, size.y, size.z);
+	// Every offset in the load area, nearest first
+	static const std::vector<glm::ivec3> LOAD_SPIRAL{[]
+	{
+		const int VERTICAL_LOAD_DISTANCE = 2;
+		std::vector<glm::ivec3> offsets;
+		for(int x = -LOAD_DISTANCE; x <= LOAD_DISTANCE; ++x)
+			for(int y = -VERTICAL_LOAD_DISTANCE; y <= VERTICAL_LOAD_DISTANCE; ++y)
+				for(int z = -LOAD_DISTANCE; z <= LOAD_DISTANCE; ++z) offsets.push_back({x, y, z});
+		std::stable_sort(offsets.begin(), offsets.end(), [](const glm::ivec3& a, const glm::ivec3& b)
+			{ return a.x*a.x+a.y*a.y+a.z*a.z < b.x*b.x+b.y*b.y+b.z*b.z; });
+		return offsets;
+	}()};
+	return LOAD_SPIRAL;
 }
 
-void Tetra::World::populate_chunk_pass_1(Tetra::Chunk *chunk)
+glm::fvec3 Tetra::World::get_predicted_position()
+{ return Oreginum::Camera::get_position()+Oreginum::Camera::get_velocity()*PREDICTION_SECONDS; }
+
+glm::ivec3 Tetra::World::get_load_center()
 {
-	// Get chunk position in world coordinates
-	glm::ivec3 chunk_world_pos = world_pos_to_chunk_pos(chunk->get_translation());
-	glm::ivec3 chunk_offset = chunk_world_pos * static_cast<int>(CHUNK_SIZE);
-	
-	const glm::ivec3 CHUNK_OFFSET{chunk_offset.x, chunk_offset.y, chunk_offset.z},
-		OFFSET_2D{CHUNK_OFFSET.z, CHUNK_OFFSET.x, 0}, SIZE_2D{CHUNK_SIZE, CHUNK_SIZE, 1};
-	constexpr uint8_t RISES_BASES_HEIGHT{20}, EARTH_RANGE{50}, MOUNTAINOUSNESS_RANGE{200};
-
-	float *mountainousness_set{simplex(OFFSET_2D, SIZE_2D, .003f, 7, SEED)};
-
-	float *earth_set{simplex(OFFSET_2D, SIZE_2D, .0005f, 1, SEED+1)};
-	float *hills_set{simplex(OFFSET_2D, SIZE_2D, .01f, 2, SEED+2)};
-	float *detail_set{simplex(OFFSET_2D, SIZE_2D, .01f, 1, SEED+3)};
-	float *plateau_fill_set{simplex({CHUNK_OFFSET.z, CHUNK_OFFSET.x, CHUNK_OFFSET.y},
-		{CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE}, .002f, 7, SEED+4)};
-	float *plateau_height_set{simplex(OFFSET_2D, SIZE_2D, .003f, 2, SEED+5)};
-		
-	//Create ground
-	uint32_t noise_index_2d{}, noise_index_3d{};
-	for(uint8_t z{}; z < CHUNK_SIZE; ++z)
-		for(uint8_t x{}; x < CHUNK_SIZE; ++x)
-		{
-			for(uint8_t y{}; y < CHUNK_SIZE; ++y)
-			{
-				const float MOUNTAINOUSNESS{std::max(
-					mountainousness_set[noise_index_2d]*
-					MOUNTAINOUSNESS_RANGE, 0.f)};
+	// Horizontally lead towards the predicted chunk, vertically the distances are equal
+	constexpr int LEAD{LOAD_DISTANCE-RENDER_DISTANCE};
+	const glm::ivec3 OFFSET{glm::clamp(world_pos_to_chunk_pos(get_predicted_position())-
+		current_player_chunk, glm::ivec3{-LEAD, 0, -LEAD}, glm::ivec3{LEAD, 0, LEAD})};
+	return current_player_chunk+OFFSET;
+}
 
-				float VOXEL_Y{static_cast<float>(chunk_offset.y + y)};
+void Tetra::World::set_chunk_queue_views()
+{
+	const glm::fvec3 PREDICTED_POSITION{get_predicted_position()};
+	load_queue.set_view(PREDICTED_POSITION, Oreginum::Camera::get_direction());
+	for(Chunk_Queue& q : chunk_queues)
+		q.set_view(PREDICTED_POSITION, Oreginum::Camera::get_direction());
+}
 
-				const float EARTH{earth_set[noise_index_2d]*EARTH_RANGE};
-				const float HILLS{hills_set[noise_index_2d]*5*MOUNTAINOUSNESS/30};
-				const float DETAIL{detail_set[noise_index_2d]*2};
-				const float GROUND{EARTH+HILLS+DETAIL};
+void Tetra::World::count_visible_holes()
+{
+	// Chunks in render distance whose bounding sphere meets the cone around the view
+	// frustum's corners, and that have never been uploaded, are holes in the world
+	const glm::fvec3 POSITION{Oreginum::Camera::get_position()},
+		DIRECTION{Oreginum::Camera::get_direction()};
+	const glm::fmat4& PROJECTION{Oreginum::Camera::get_projection()};
+	const float HALF_ANGLE{std::atan(std::sqrt(1/(PROJECTION[0][0]*PROJECTION[0][0])+
+		1/(PROJECTION[1][1]*PROJECTION[1][1])))};
+	const float CHUNK_RADIUS{CHUNK_SIZE*std::sqrt(3.f)/2};
+	const int VERTICAL_RENDER_DISTANCE = 2;
 
-				const float PLATEAU_HEIGHT{EARTH+plateau_height_set[noise_index_2d]*
-					MOUNTAINOUSNESS-RISES_BASES_HEIGHT+DETAIL};
-				const float PLATEAU{VOXEL_Y > PLATEAU_HEIGHT ?
-					plateau_fill_set[noise_index_3d]*(VOXEL_Y-PLATEAU_HEIGHT) : 0};
+	std::unordered_set<glm::ivec3, ivec3_hash> holes;
+	{
+		std::lock_guard<std::mutex> chunks_guard{chunks_mutex};
+		for(int x = -RENDER_DISTANCE; x <= RENDER_DISTANCE; ++x)
+			for(int y = -VERTICAL_RENDER_DISTANCE; y <= VERTICAL_RENDER_DISTANCE; ++y)
+				for(int z = -RENDER_DISTANCE; z <= RENDER_DISTANCE; ++z)
+				{
+					const glm::ivec3 CHUNK_POSITION{current_player_chunk+glm::ivec3{x, y, z}};
+					const glm::fvec3 OFFSET{(glm::fvec3(CHUNK_POSITION)+.5f)*
+						static_cast<float>(CHUNK_SIZE)-POSITION};
+					const float DISTANCE{glm::length(OFFSET)};
+					if(DISTANCE > CHUNK_RADIUS && std::acos(glm::clamp(glm::dot(OFFSET/DISTANCE,
+						DIRECTION), -1.f, 1.f))-std::asin(CHUNK_RADIUS/DISTANCE) > HALF_ANGLE)
+						continue;
+
+					const auto CHUNK{loaded_chunks.find(CHUNK_POSITION)};
+					if(CHUNK == loaded_chunks.end() || !CHUNK->second->is_uploaded())
+						holes.insert(CHUNK_POSITION);
+				}
+	}
 
-				if(VOXEL_Y > GROUND || PLATEAU > .1)
-					chunk->set_voxel_material({x, y, z}, Materials::STONE);
+	for(const glm::ivec3& h : holes) if(!hole_chunks.count(h)) ++visible_holes;
+	hole_chunks = std::move(holes);
+}
 
-				++noise_index_3d;
-			}
-			++noise_index_2d;
-		}
+bool Tetra::World::is_spawn_ready()
+{
+	// The chunks around the player have been meshed
+	for(int z = -1; z <= 1; ++z)
+		for(int y = -1; y <= 1; ++y)
+			for(int x = -1; x <= 1; ++x)
+				if(!is_dependency_met(current_player_chunk+glm::ivec3{x, y, z}, Chunk::MESHED))
+					return false;
+	return true;
+}
 
-	FastNoiseSIMD::FreeNoiseSet(plateau_height_set);
-	FastNoiseSIMD::FreeNoiseSet(plateau_fill_set);
-	FastNoiseSIMD::FreeNoiseSet(detail_set);
-	FastNoiseSIMD::FreeNoiseSet(hills_set);
-	FastNoiseSIMD::FreeNoiseSet(earth_set);
-	FastNoiseSIMD::FreeNoiseSet(mountainousness_set);
+bool Tetra::World::can_submit_job()
+{
+	//Forget finished jobs, and keep enough in flight for idle workers to steal
+	jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const auto& j)
+		{ return Oreginum::Job_System::is_done(j.second); }), jobs.end());
+	return jobs.size() < Oreginum::Job_System::get_worker_count()*JOBS_PER_WORKER;
 }
 
-bool Tetra::World::axis_bounds_check(glm::u8vec3 values, glm::u8vec3 minimum, glm::u8vec3 maximum)
+void Tetra::World::submit_job(const std::function<void(uint8_t)>& task)
+{ jobs.emplace_back(++submitted_jobs, Oreginum::Job_System::submit(task)); }
+
+void Tetra::World::retire(Chunk *chunk, std::vector<Render_Group>&& render_groups)
 {
-	for(uint8_t axis{}; axis < 3; ++axis)
-		if(values[axis] < minimum[axis] || values[axis] > maximum[axis]) return true;
-	return false;
+	if(chunk) ++retired_chunks;
+	retired.push_back({chunk, std::move(render_groups),
+		Oreginum::Renderer_Core::get_submitted_frames(), submitted_jobs});
 }
 
-void Tetra::World::inter_chunk_set(Tetra::Chunk *chunk, glm::i16vec3 voxel_index, uint8_t material)
+void Tetra::World::reclaim_retired()
 {
-	//If outside current chunk
-	if(axis_bounds_check(glm::u8vec3(voxel_index), glm::u8vec3{0}, glm::u8vec3{CHUNK_SIZE-1}))
+	//Jobs finish out of order, so only those older than the oldest unfinished job are known
+	//to be done, and frames complete in order. Both only grow, so the front is always the
+	//first entry ready.
+	can_submit_job();
+	const uint64_t FINISHED_JOBS{jobs.empty() ? submitted_jobs : jobs.front().first-1};
+	const uint64_t COMPLETED_FRAMES{Oreginum::Renderer_Core::get_completed_frames()};
+	while(!retired.empty() && retired.front().job <= FINISHED_JOBS &&
+		retired.front().frame <= COMPLETED_FRAMES)
 	{
-		// Calculate which chunk this voxel belongs to
-		glm::ivec3 current_chunk_pos = world_pos_to_chunk_pos(chunk->get_translation());
-		glm::ivec3 target_chunk_pos = current_chunk_pos;
-		
-		// Adjust chunk position and voxel index based on which boundary was crossed
-		for(uint8_t axis = 0; axis < 3; ++axis)
-		{
-			if(voxel_index[axis] < 0) 
-			{
-				--target_chunk_pos[axis];
-				voxel_index[axis] = static_cast<int16_t>(CHUNK_SIZE) + voxel_index[axis];
-			}
-			else if(voxel_index[axis] >= CHUNK_SIZE) 
-			{
-				++target_chunk_pos[axis];
-				voxel_index[axis] = voxel_index[axis] - static_cast<int16_t>(CHUNK_SIZE);
-			}
-		}
-
-		// Try to find the target chunk
-		Tetra::Chunk* target_chunk = get_chunk_at(target_chunk_pos);
-		if(target_chunk && !target_chunk->is_being_deleted())
+		Chunk *chunk{retired.front().chunk};
+		retired.pop_front();
+		if(!chunk) continue;
+		--retired_chunks;
+
+		// Chunks generated this session are saved first, on a worker as encoding reads
+		// every voxel, and retired again until the save job is done. Whether or not they
+		// were meshed, tree voxels they got from neighbours after this are journaled.
+		if(persistence == SNAPSHOTS && chunk->is_generated() && !chunk->is_stored())
 		{
-			target_chunk->set_voxel_material(glm::u8vec3(voxel_index), material);
+			chunk->set_stored(true);
+			submit_job([this, chunk](uint8_t){ save_chunk(chunk); });
+			retire(chunk, {});
 		}
-		// If chunk doesn't exist or is being deleted, we just ignore the voxel
-		// This is acceptable for features like trees that span chunk boundaries
-	}
-	//If inside current chunk
-	else 
-	{
-		chunk->set_voxel_material(glm::u8vec3(voxel_index), material);
+		else delete chunk;
 	}
 }
 
-void Tetra::World::create_tree(Tetra::Chunk *chunk, glm::i16vec3 base_voxel_index)
-{
-	base_voxel_index -= glm::i16vec3{TREE_SIZE.x/2, 0, TREE_SIZE.z/2};
-
-	for(int8_t y{}; y < TREE_SIZE.y; ++y)
-		for(int8_t x{}; x < TREE_SIZE.x; ++x)
-			for(int8_t z{}; z < TREE_SIZE.z; ++z)
-			{
-				glm::i16vec3 voxel_index{base_voxel_index};
-				voxel_index += glm::i16vec3{x, -y, z}; // Flip Y to account for downward-increasing coordinates
-				uint8_t material{TREE[y][z][x]};
-				if(!material) continue;
-				inter_chunk_set(chunk, voxel_index, material);
-			}
-}
-
-void Tetra::World::populate_chunk_pass_2(Tetra::Chunk *chunk)
+void Tetra::World::update()
 {
-	const glm::ivec3 chunk_world_pos = chunk->get_translation();
-	const glm::ivec3 CHUNK_OFFSET{chunk_world_pos.x, chunk_world_pos.y, chunk_world_pos.z};
-	const glm::ivec3 OFFSET_2D{CHUNK_OFFSET.z, CHUNK_OFFSET.x, 0};
-	const glm::ivec3 SIZE_2D{CHUNK_SIZE, CHUNK_SIZE, 1};
-
-	float *tree_area_set{simplex(OFFSET_2D, SIZE_2D, .003f, 5, SEED+6)};
-
-	uint32_t noise_index_2d{};
+	// Update chunks around player first
+	update_chunks_around_player();
+	count_visible_holes();
 	
-	// Process each column (x,z) in this chunk
-	for(uint8_t voxel_z{}; voxel_z < CHUNK_SIZE; ++voxel_z)
+	//Free chunks and render groups no frame or job can still be using, and write this
+	//frame's edits
+	reclaim_retired();
+	edit_journal.flush();
+
+	//Upload meshes while they fit the frame's budget, once the meshing job has released
+	//the chunk. Chunks unloaded since they were meshed are no longer found, or have left
+	//the meshed state.
+	upload_scheduler.begin_frame(Oreginum::Core::get_delta(),
+		1.f/Oreginum::Core::get_refresh_rate(), Oreginum::Renderer_Core::get_record_seconds());
 	{
-		for(uint8_t voxel_x{}; voxel_x < CHUNK_SIZE; ++voxel_x)
+		std::lock_guard<std::mutex> add_queue_guard{add_queue_mutex};
+		while(!add_queue.empty())
 		{
-			// Find the surface level for this column by scanning from top to bottom  
-			// Since Y increases downward, Y=0 is "top" and Y=CHUNK_SIZE-1 is "bottom"
-			int surface_y = -1;
-			bool water_surface = false;
-			
-			// First pass: find surface level (scan from top Y=0 to bottom Y=CHUNK_SIZE-1)
-			for(int voxel_y = 0; voxel_y < CHUNK_SIZE; ++voxel_y)
-			{
-				glm::u8vec3 voxel_index{voxel_x, static_cast<uint8_t>(voxel_y), voxel_z};
-				uint8_t voxel_material = chunk->get_voxel_material(voxel_index);
-				float world_y = static_cast<float>(chunk_world_pos.y + voxel_y);
-				
-				// If we find solid material (stone from pass 1), this is our surface
-				if(voxel_material == Materials::STONE)
-				{
-					surface_y = voxel_y;
-					break;
-				}
-				// If we're below water level and no solid found yet, check for water placement  
-				else if(world_y >= -10 && world_y <= -5 && voxel_material == 0 && surface_y == -1)
-				{
-					// This could be water surface
-					water_surface = true;
-					surface_y = voxel_y;
-				}
-			}
-			
-			// Second pass: assign materials based on distance from surface
-			for(uint8_t voxel_y{}; voxel_y < CHUNK_SIZE; ++voxel_y)
+			Chunk *chunk{get_chunk_at(add_queue.front().first)};
+			if(chunk && chunk->is_claimed()) break;
+			const size_t BYTES{chunk ? chunk->get_mesh_bytes() : 0};
+			if(chunk && chunk->get_state() == Chunk::MESHED &&
+				!upload_scheduler.can_upload(BYTES)) break;
+			if(chunk && chunk->transition(Chunk::MESHED, Chunk::UPLOADED))
 			{
-				glm::u8vec3 voxel_index{voxel_x, voxel_y, voxel_z};
-				uint8_t voxel_material = chunk->get_voxel_material(voxel_index);
-				float world_y = static_cast<float>(chunk_world_pos.y + voxel_y);
-				
-				// Calculate depth from surface
-				int depth_from_surface = surface_y >= 0 ? static_cast<int>(voxel_y) - surface_y : -999;
-				
-				// Water placement - only in empty spaces that are below water level
-				if(world_y >= -10 && world_y <= -5 && voxel_material == 0)
-				{
-					chunk->set_voxel_material(voxel_index, Materials::WATER);
-					voxel_material = Materials::WATER;
-				}
-				// Sand near water level - only replace stone that's near water
-				else if(world_y >= -10 && world_y <= -3 && voxel_material == Materials::STONE && surface_y >= 0 && depth_from_surface >= -2 && depth_from_surface <= 2)
-				{
-					chunk->set_voxel_material(voxel_index, Materials::SAND);
-				}
-				// Surface and subsurface materials
-				else if(voxel_material == Materials::STONE && surface_y >= 0)
-				{
-					if(depth_from_surface == 0) // Surface
-					{
-						chunk->set_voxel_material(voxel_index, Materials::GRASS);
-						
-						// Only place trees on actual surface blocks
-						float random = static_cast<float>(rand() % 2000) / 100.0f;
-						const bool TREE = random < std::max(tree_area_set[noise_index_2d], 0.0f);
-						if(TREE)
-						{
-							// Place tree base at the grass block
-							glm::i16vec3 tree_base = glm::i16vec3(voxel_index);
-							create_tree(chunk, tree_base);
-						}
-					}
-					else if(depth_from_surface > 0 && depth_from_surface <= 4) // Below surface (dirt layer)
-					{
-						chunk->set_voxel_material(voxel_index, Materials::DIRT);
-					}
-					// Stone remains stone for deeper areas
-				}
+				const std::chrono::steady_clock::time_point START{
+					std::chrono::steady_clock::now()};
+				retire(nullptr, chunk->release_render_groups());
+				chunk->create_render_groups();
+				chunk->add_render_groups();
+				const std::chrono::steady_clock::time_point END{
+					std::chrono::steady_clock::now()};
+				upload_scheduler.record(BYTES, std::chrono::duration<float>(END-START).count(),
+					std::chrono::duration<float>(END-add_queue.front().second).count());
+
+				//Crossings only revisit chunks near the player, so one meshed for an
+				//older player chunk is sent back here if its detail is out of date, as is
+				//one edited after it replayed its edits
+				const glm::ivec3 CHUNK_POSITION{add_queue.front().first};
+				const bool STALE_LOD{is_chunk_in_render_distance(CHUNK_POSITION,
+					current_player_chunk) && (chunk->get_lod() != get_chunk_lod(CHUNK_POSITION,
+					current_player_chunk) || chunk->get_skirts() != get_chunk_skirts(CHUNK_POSITION))};
+				if((STALE_LOD || chunk->get_edit_revision() !=
+					edit_journal.get_revision(CHUNK_POSITION)) &&
+					refresh_chunk(CHUNK_POSITION, chunk)) queue_chunk(CHUNK_POSITION);
 			}
-			
-			++noise_index_2d;
+			add_queue.pop_front();
 		}
+		upload_scheduler.set_queue_depth(add_queue.size());
+	}
+
+	//Queue chunks made ready by finished stages, then hand out work stage by stage,
+	//each chunk only waits on its own neighbours
+	process_completions();
+
+	//First pass population, at the detail the chunk will be meshed at
+	Tetra::Chunk *population_pass_1_chunk{nullptr};
+	while(can_submit_job() && (population_pass_1_chunk = pop_chunk(POPULATION_PASS_1)))
+	{
+		const uint8_t LOD{get_chunk_lod(world_pos_to_chunk_pos(
+			population_pass_1_chunk->get_translation()), current_player_chunk)};
+		submit_job([this, population_pass_1_chunk, LOD](uint8_t)
+			{ population_pass_1(population_pass_1_chunk, LOD); });
+	}
+
+	//Second pass population
+	Tetra::Chunk *population_pass_2_chunk{nullptr};
+	while(can_submit_job() && (population_pass_2_chunk = pop_chunk(POPULATION_PASS_2)))
+	{
+		submit_job([this, population_pass_2_chunk](uint8_t)
+			{ population_pass_2(population_pass_2_chunk); });
 	}
 
-	FastNoiseSIMD::FreeNoiseSet(tree_area_set);
+	//Cull and mesh unmeshed chunks, then add them to the add queue
+	Tetra::Chunk *unmeshed_chunk{nullptr};
+	while(can_submit_job() && (unmeshed_chunk = pop_chunk(MESHING)))
+	{
+		const glm::ivec3 CHUNK_POSITION{world_pos_to_chunk_pos(unmeshed_chunk->get_translation())};
+		const uint8_t LOD{get_chunk_lod(CHUNK_POSITION, current_player_chunk)},
+			SKIRTS{get_chunk_skirts(CHUNK_POSITION)};
+		submit_job([this, unmeshed_chunk, LOD, SKIRTS](uint8_t worker)
+			{ mesh_chunk(unmeshed_chunk, worker, LOD, SKIRTS); });
+	}
 }
 
-void Tetra::World::transparent_neighbor_cull(Tetra::Chunk *chunk, const glm::u8vec3& voxel_position)
+void Tetra::World::transparent_neighbor_cull(Tetra::Chunk *chunk, const glm::u8vec3& voxel_position,
+	uint8_t skirts)
 {
 	constexpr glm::i8vec3 NEIGHBORS[CUBE_FACES]{{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, 
 		{0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
@@ -662,9 +965,14 @@ void Tetra::World::transparent_neighbor_cull(Tetra::Chunk *chunk, const glm::u8v
 				}
 			}
 
-			// Try to get the neighboring chunk
+			// Try to get the neighboring chunk, faces towards one meshed at another level of
+			// detail are skirts and left unculled
 			Tetra::Chunk* neighbor_chunk = get_chunk_at(neighbor_chunk_pos);
-			if(neighbor_chunk && !neighbor_chunk->is_being_deleted())
+			if(skirts&0b1<<face)
+			{
+				is_transparent = true;
+			}
+			else if(neighbor_chunk && !neighbor_chunk->is_retiring())
 			{
 				is_transparent = neighbor_chunk->is_voxel_transparent(glm::u8vec3(neighbor_voxel));
 			}
@@ -680,14 +988,14 @@ void Tetra::World::transparent_neighbor_cull(Tetra::Chunk *chunk, const glm::u8v
 	}
 }
 
-void Tetra::World::cull_chunk(Tetra::Chunk *chunk)
+void Tetra::World::cull_chunk(Tetra::Chunk *chunk, uint8_t skirts)
 {
-	for(uint8_t z{}; z < CHUNK_SIZE; ++z)
+	for(uint8_t z{}; z < CHUNK_SIZE && !chunk->is_retiring(); ++z)
 		for(uint8_t y{}; y < CHUNK_SIZE; ++y)
 			for(uint8_t x{}; x < CHUNK_SIZE; ++x)
 			{
 				glm::u8vec3 voxel_position{x, y, z};
 				if(!chunk->is_voxel_transparent(voxel_position))
-					transparent_neighbor_cull(chunk, voxel_position);
+					transparent_neighbor_cull(chunk, voxel_position, skirts);
     }
 } 
\ No newline at end of file
@@ -1,24 +1,36 @@
 #pragma once
 #include "Common.hpp"
 #include "Chunk.hpp"
+#include "Chunk Queue.hpp"
+#include "Upload Scheduler.hpp"
+#include "Region Store.hpp"
+#include "Edit Journal.hpp"
+#include "Mesh Cache.hpp"
+#include "Generator.hpp"
 #include <unordered_map>
 #include <unordered_set>
+#include <deque>
+#include <chrono>
 #include "../Oreginum/Camera.hpp"
 #include "../Oreginum/Renderer Core.hpp"
+#include "../Oreginum/Job System.hpp"
 
 namespace Tetra
 {
-	// Hash function for glm::ivec3
-	struct ivec3_hash {
-		std::size_t operator()(const glm::ivec3& v) const {
-			return std::hash<int>()(v.x) ^ (std::hash<int>()(v.y) << 1) ^ (std::hash<int>()(v.z) << 2);
-		}
-	};
-
 	class World
 	{
 	public:
-		World();
+		// Snapshots store every chunk generated, edits store only voxels changed after
+		// generation and regenerate the rest
+		enum Persistence{SNAPSHOTS, EDITS};
+		// Loaded chunks, and retired ones not yet freed, are kept within a memory budget.
+		// The default has room for the 1445 chunk render area and about one 95 chunk slab
+		// of the 1805 chunk load area, so prefetching beyond render distance only goes as
+		// far as memory allows and a chunk entering render distance takes the memory of
+		// the farthest one prefetched. Budgets below the render area leave holes.
+		static constexpr size_t DEFAULT_CHUNK_MEMORY_BUDGET{1536*sizeof(Chunk)};
+		World(Persistence persistence = SNAPSHOTS,
+			size_t chunk_memory_budget = DEFAULT_CHUNK_MEMORY_BUDGET);
 		~World();
 		void update();
 
@@ -28,51 +40,150 @@ namespace Tetra
 		bool is_chunk_loaded(const glm::ivec3& chunk_pos);
 		void load_chunk(const glm::ivec3& chunk_pos);
 		void unload_chunk(const glm::ivec3& chunk_pos);
+		// The first opaque voxel along the ray within the distance, and the voxel before it
+		bool raycast(const glm::fvec3& origin, const glm::fvec3& direction, float distance,
+			glm::ivec3 *hit, glm::ivec3 *previous);
+		// Changes the voxel at a world position, journaled and replayed whenever its chunk loads
+		void set_voxel(const glm::ivec3& position, uint8_t material);
+		const Upload_Scheduler::Statistics& get_upload_statistics() const
+		{ return upload_scheduler.get_statistics(); }
+		// Chunks that came into view before they had a mesh, counted once each
+		uint64_t get_visible_holes() const { return visible_holes; }
+		// The work done when the player or load area last moved to another chunk
+		struct Crossing_Statistics
+		{
+			uint64_t crossings;
+			size_t chunks;
+			float seconds, maximum_seconds;
+		};
+		const Crossing_Statistics& get_crossing_statistics() const { return crossing_statistics; }
+		Mesh_Cache::Statistics get_mesh_cache_statistics(){ return mesh_cache.get_statistics(); }
+		Region_Store::Statistics get_save_statistics(){ return region_store.get_statistics(); }
 
 	private:
 		// Infinite world data structure
 		std::unordered_map<glm::ivec3, Chunk*, ivec3_hash> loaded_chunks;
 		std::unordered_set<glm::ivec3, ivec3_hash> chunks_to_load;
-		std::unordered_set<glm::ivec3, ivec3_hash> chunks_to_unload;
+		std::vector<glm::ivec3> chunks_to_unload;
 		
 		// Player tracking
 		glm::ivec3 current_player_chunk;
 		glm::ivec3 last_player_chunk;
+
+		// Chunks generated this session are saved as they are freed, and read back instead
+		// of generated when they load again. Edits are journaled either way and replayed
+		// over the chunk when it is meshed, as are tree voxels written across a border into
+		// a chunk that may not keep them, such as a stored one.
+		Persistence persistence;
+		Region_Store region_store;
+		Edit_Journal edit_journal;
+		Generator generator;
 		
 		// Render and load distances
-		static constexpr int RENDER_DISTANCE = 1; // 3x3 area (1 chunk radius)
-		static constexpr int LOAD_DISTANCE = 8;   // 16x16 area (8 chunk radius)
+		static constexpr int RENDER_DISTANCE = 8; // 17x17 area (8 chunk radius)
+		static constexpr int LOAD_DISTANCE = 9;   // 19x19 area (9 chunk radius)
+
+		// Chunk distances up to which each level of detail is used, beyond the last
+		// one chunks are meshed at the lowest detail. Generated chunks are populated at
+		// the detail they are first meshed at, and populated again in place when they
+		// come closer, after which their neighbours are remeshed. Chunks wait to be
+		// populated again until no neighbour is writing into or reading their voxels.
+		static constexpr int LOD_DISTANCES[Chunk::LODS-1]{1, 3, 5};
+		std::unordered_set<glm::ivec3, ivec3_hash> refinements, refining_chunks;
+
+		// Loaded chunks, and retired ones not yet freed, counted against the budget
+		size_t chunk_memory_budget;
+		std::atomic<uint32_t> retired_chunks{};
+
+		// Prefetching, work is ordered around where the camera will be and the load area
+		// leads the player along its movement by up to the margin between the load and
+		// render distances, so every chunk in render distance stays loaded
+		static constexpr float PREDICTION_SECONDS{1.f};
+		glm::ivec3 load_center;
+		Chunk_Queue load_queue;
+		std::unordered_set<glm::ivec3, ivec3_hash> hole_chunks;
+		uint64_t visible_holes{};
+		Crossing_Statistics crossing_statistics{};
+
+		// Chunks ready for each stage, closest and most in view first, and chunks
+		// whose stage finished, or that were given deferred voxels, on a worker since
+		// the last update
+		enum Stages{POPULATION_PASS_1, POPULATION_PASS_2, MESHING, STAGES};
+		Chunk_Queue chunk_queues[STAGES];
+		std::vector<glm::ivec3> completions, deferred_chunks;
+		std::mutex completions_mutex;
+		// Queues are rekeyed once the view turns, or the predicted position moves, further
+		// than this from their ordering
+		static constexpr float REKEY_VIEW_COSINE{.9f}, REKEY_DISTANCE{CHUNK_SIZE/2.f};
 		
+		// Chunks and render groups removed from the world, stamped with the frame and job
+		// counts at removal, they are freed once every frame and job before them is done
+		struct Retired
+		{
+			Chunk *chunk;
+			std::vector<Render_Group> render_groups;
+			uint64_t frame, job;
+		};
+		std::deque<Retired> retired;
+
+		// Meshes of chunks that unloaded, or changed level of detail, kept for when they
+		// are meshed again unchanged
+		static constexpr size_t MESH_CACHE_BUDGET{256*1024*1024};
+		Mesh_Cache mesh_cache{MESH_CACHE_BUDGET};
+
+		// Meshed chunks waiting for upload, with the time their mesh finished
+		std::deque<std::pair<glm::ivec3, std::chrono::steady_clock::time_point>> add_queue;
+		Upload_Scheduler upload_scheduler;
+
 		// Threading
-		std::vector<std::pair<Chunk *, uint8_t>> deletion_queue;
-		std::vector<Chunk *> add_queue;
-		std::thread threads[THREADS];
-		bool is_thread_busy[THREADS];
-		bool was_thread_launched[THREADS];
-		bool populated, meshed;
-		std::mutex add_queue_mutex, deletion_queue_mutex, chunks_mutex;
+		static constexpr uint8_t JOBS_PER_WORKER{2};
+		std::deque<std::pair<uint64_t, Oreginum::Job_System::Handle>> jobs;
+		uint64_t submitted_jobs{};
+		std::vector<Mesh_Arena> mesh_arenas;
+		std::mutex add_queue_mutex, chunks_mutex;
 
-		void population_pass_1(Chunk *chunk, uint8_t thread_index);
-		void population_pass_2(Chunk *chunk, uint8_t thread_index);
-		void mesh_chunk(Chunk *chunk, uint8_t thread_index);
-		Chunk *get_population_pass_1_chunk();
-		Chunk *get_population_pass_2_chunk();
-		Chunk *get_unmeshed_chunk();
-		int8_t get_thread();
-		float *simplex(const glm::ivec3& offset, const glm::ivec3& size,
-			float frequency, uint32_t octaves, uint32_t seed);
-		bool float_equals(float a, float b, float range){ return abs(a-b) < range; }
-		void populate_chunk_pass_1(Chunk *chunk);
-		bool axis_bounds_check(glm::u8vec3 values, glm::u8vec3 minimum, glm::u8vec3 maximum);
-		void inter_chunk_set(Chunk *chunk, glm::i16vec3 voxel_index, uint8_t material);
-		void create_tree(Chunk *chunk, glm::i16vec3 base_voxel_index);
-		void populate_chunk_pass_2(Chunk *chunk);
-		void transparent_neighbor_cull(Chunk *chunk, const glm::u8vec3& voxel_position);
-		void cull_chunk(Chunk *chunk);
+		void save_chunk(Chunk *chunk);
+		void population_pass_1(Chunk *chunk, uint8_t lod);
+		void population_pass_2(Chunk *chunk);
+		void defer_voxel(const glm::ivec3& chunk_pos, const glm::u8vec3& voxel, uint8_t material);
+		void apply_edits(Chunk *chunk);
+		void mesh_chunk(Chunk *chunk, uint8_t worker_index, uint8_t lod, uint8_t skirts);
+		uint8_t get_chunk_stage(Chunk *chunk);
+		bool is_dependency_met(const glm::ivec3& chunk_pos, Chunk::State state);
+		bool is_chunk_ready(const glm::ivec3& chunk_pos, uint8_t stage);
+		void queue_chunk(const glm::ivec3& chunk_pos);
+		void complete_chunk(Chunk *chunk);
+		void process_completions();
+		Chunk *pop_chunk(uint8_t stage);
+		bool has_chunk_memory();
+		bool evict_prefetched_chunk();
+		static const std::vector<glm::ivec3>& get_load_spiral();
+		glm::fvec3 get_predicted_position();
+		glm::ivec3 get_load_center();
+		void set_chunk_queue_views();
+		void count_visible_holes();
+		bool is_spawn_ready();
+		bool can_submit_job();
+		void submit_job(const std::function<void(uint8_t)>& task);
+		void retire(Chunk *chunk, std::vector<Render_Group>&& render_groups);
+		void reclaim_retired();
+		void transparent_neighbor_cull(Chunk *chunk, const glm::u8vec3& voxel_position,
+			uint8_t skirts);
+		void cull_chunk(Chunk *chunk, uint8_t skirts);
 
 		// Helper functions for infinite world
 		Chunk* get_chunk_at(const glm::ivec3& chunk_pos);
 		bool is_chunk_in_render_distance(const glm::ivec3& chunk_pos, const glm::ivec3& player_chunk);
 		bool is_chunk_in_load_distance(const glm::ivec3& chunk_pos, const glm::ivec3& player_chunk);
+		uint8_t get_chunk_lod(const glm::ivec3& chunk_pos, const glm::ivec3& player_chunk);
+		uint8_t get_chunk_skirts(const glm::ivec3& chunk_pos);
+		bool refresh_chunk(const glm::ivec3& chunk_pos, Chunk *chunk);
+		bool is_neighborhood_busy(const glm::ivec3& chunk_pos);
+		void refine_chunks();
+		void update_chunk_lods(const glm::ivec3& previous_player_chunk);
+		void get_area_difference(const glm::ivec3& center, const glm::ivec3& other_center,
+			const glm::ivec3& extent, std::vector<glm::ivec3> *chunk_positions);
+		size_t move_load_area(const glm::ivec3& center);
+		size_t move_render_area();
 	};
 }
\ No newline at end of file
@@ -17,6 +17,8 @@ namespace
 	const glm::fvec3 world_right{1, 0, 0};
 	const glm::fvec3 world_forward{0, 0, 1};
 	glm::fvec3 position{0, -100, 0};
+	glm::fvec3 previous_position{position};
+	glm::fvec3 velocity;
 	glm::fvec3 direction{-.43704, .805192, -.400826};
 	glm::fvec3 forward{glm::normalize(direction*glm::fvec3{1, 0, 1})};
 	glm::fvec3 right{glm::normalize(glm::cross(direction, world_up))};
@@ -57,6 +59,10 @@ void Oreginum::Camera::update()
 	if(Keyboard::is_held(Key::A)) position -= right*velocity;
 	if(Keyboard::is_held(Key::D)) position += right*velocity;
 
+	//Velocity over the last frame, including any movement from set_position
+	if(Core::get_delta() > 0) ::velocity = (position-previous_position)/Core::get_delta();
+	previous_position = position;
+
 	view = glm::lookAt(position, position+direction, world_up);
 
 	projection = glm::perspective(FOV, Window::get_resolution().x/
@@ -76,6 +82,8 @@ const glm::fvec3& Oreginum::Camera::get_position(){ return position; }
 
 const glm::fvec3& Oreginum::Camera::get_direction(){ return direction; }
 
+const glm::fvec3& Oreginum::Camera::get_velocity(){ return velocity; }
+
 const glm::fmat4& Oreginum::Camera::get_view(){ return view; }
 
 const glm::fmat4& Oreginum::Camera::get_projection(){ return projection; }
@@ -14,6 +14,7 @@ namespace Oreginum
 		float get_fov();
 		const glm::fvec3& get_position();
 		const glm::fvec3& get_direction();
+		const glm::fvec3& get_velocity();
 		const glm::fmat4& get_view();
 		const glm::fmat4& get_projection();
         glm::fmat4 get_normalized_orthographic();
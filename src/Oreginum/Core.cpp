@@ -8,6 +8,8 @@
 #include "Camera.hpp"
 #include "Core.hpp"
 #include "Main Renderer.hpp"
+#include "Job System.hpp"
+#include "Resource Pack.hpp"
 
 namespace
 {
@@ -37,11 +39,14 @@ void Oreginum::Core::initialize(const std::string& title,
 
 	Window::initialize(title, resolution, terminal);
 	Mouse::initialize();
+	Resource_Pack::initialize("Resources/Resources.pack");
+	Job_System::initialize();
 	Renderer_Core::initialize();
 }
 
 void Oreginum::Core::destroy()
 {
+	Job_System::destroy();
 	Mouse::destroy();
 	Window::destroy();
 	Renderer_Core::get_device()->get().waitIdle();
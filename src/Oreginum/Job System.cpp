@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "Job System.hpp"
+
+namespace
+{
+	//Each worker pops its own queue from the back and steals from the front of the others
+	struct Worker_Queue
+	{
+		std::mutex mutex;
+		std::deque<Oreginum::Job_System::Handle> jobs;
+	};
+
+	std::vector<std::thread> workers;
+	std::unique_ptr<Worker_Queue[]> queues;
+	uint8_t worker_count;
+	std::atomic<uint32_t> submitted_jobs, next_queue;
+	std::atomic<bool> quitting;
+	std::mutex sleep_mutex;
+	std::condition_variable sleep_condition;
+	thread_local uint8_t worker_index{UINT8_MAX};
+
+	Oreginum::Job_System::Handle pop(uint8_t queue, bool back)
+	{
+		std::lock_guard<std::mutex> guard{queues[queue].mutex};
+		std::deque<Oreginum::Job_System::Handle>& jobs{queues[queue].jobs};
+		if(jobs.empty()) return nullptr;
+		Oreginum::Job_System::Handle job;
+		if(back){ job = std::move(jobs.back()); jobs.pop_back(); }
+		else{ job = std::move(jobs.front()); jobs.pop_front(); }
+		return job;
+	}
+
+	Oreginum::Job_System::Handle find_job(uint8_t index)
+	{
+		Oreginum::Job_System::Handle job;
+		if(index < worker_count && (job = pop(index, true))) return job;
+		for(uint8_t i{1}; i <= worker_count; ++i)
+			if(job = pop((index+i)%worker_count, false)) return job;
+		return nullptr;
+	}
+
+	void run(const Oreginum::Job_System::Handle& job, uint8_t index)
+	{
+		job->task(index);
+		job->task = nullptr;
+		job->done.store(true, std::memory_order_release);
+	}
+
+	void work(uint8_t index)
+	{
+		worker_index = index;
+		while(true)
+		{
+			const uint32_t SUBMITTED{submitted_jobs.load()};
+			if(Oreginum::Job_System::Handle job{find_job(index)})
+			{
+				run(job, index);
+				continue;
+			}
+
+			//Sleep until a job is submitted after the search began, so a worker whose
+			//steal failed waits rather than spinning while others run the last jobs.
+			//Leave once quitting and there is nothing left to find.
+			std::unique_lock<std::mutex> lock{sleep_mutex};
+			if(quitting) return;
+			sleep_condition.wait(lock, [SUBMITTED]
+				{ return submitted_jobs != SUBMITTED || quitting; });
+		}
+	}
+
+	double time_since_epoch(){ return std::chrono::duration_cast<std::chrono::microseconds>
+		(std::chrono::high_resolution_clock::now().time_since_epoch()).count()/1000000.; }
+}
+
+void Oreginum::Job_System::initialize(uint8_t workers)
+{
+	//Leave a core for the main thread
+	if(!workers) workers = static_cast<uint8_t>(std::min(std::max(
+		std::thread::hardware_concurrency(), 2U)-1, UINT8_MAX-1U));
+
+	worker_count = workers;
+	submitted_jobs = 0, next_queue = 0, quitting = false;
+	queues.reset(new Worker_Queue[worker_count]);
+	::workers.reserve(worker_count);
+	for(uint8_t i{}; i < worker_count; ++i) ::workers.emplace_back(work, i);
+}
+
+void Oreginum::Job_System::destroy()
+{
+	if(worker_index < worker_count) return;
+
+	{
+		std::lock_guard<std::mutex> guard{sleep_mutex};
+		quitting = true;
+	}
+	sleep_condition.notify_all();
+	for(std::thread& w : workers) w.join();
+	workers.clear();
+	queues.reset();
+	worker_count = 0;
+}
+
+Oreginum::Job_System::Handle Oreginum::Job_System::submit(
+	const std::function<void(uint8_t)>& task)
+{
+	Handle job{std::make_shared<Job>()};
+	job->task = task;
+
+	//Without a pool the job runs on the calling thread
+	if(!worker_count){ run(job, 0); return job; }
+
+	//Workers push onto their own queue, anything else spreads jobs over all of them.
+	//The job is counted once it can be found, so a worker that saw the count finds it.
+	const uint8_t QUEUE{worker_index < worker_count ?
+		worker_index : static_cast<uint8_t>(next_queue++%worker_count)};
+	{
+		std::lock_guard<std::mutex> guard{queues[QUEUE].mutex};
+		queues[QUEUE].jobs.push_back(job);
+	}
+	{
+		std::lock_guard<std::mutex> guard{sleep_mutex};
+		++submitted_jobs;
+	}
+	sleep_condition.notify_one();
+	return job;
+}
+
+bool Oreginum::Job_System::is_done(const Handle& job)
+{ return !job || job->done.load(std::memory_order_acquire); }
+
+void Oreginum::Job_System::wait(const Handle& job)
+{ while(!is_done(job)) if(!help()) std::this_thread::yield(); }
+
+bool Oreginum::Job_System::help()
+{
+	const uint8_t INDEX{get_worker_index()};
+	Handle job{find_job(INDEX)};
+	if(!job) return false;
+	run(job, INDEX);
+	return true;
+}
+
+uint8_t Oreginum::Job_System::get_worker_count(){ return worker_count; }
+
+uint8_t Oreginum::Job_System::get_worker_index()
+{ return worker_index < worker_count ? worker_index : worker_count; }
+
+Oreginum::Job_System::Benchmark_Result Oreginum::Job_System::benchmark(
+	uint32_t jobs, uint32_t iterations_per_job)
+{
+	const std::function<void(uint8_t)> TASK{[iterations_per_job](uint8_t)
+	{
+		volatile uint32_t value{};
+		for(uint32_t i{}; i < iterations_per_job; ++i) value = value*1664525U+1013904223U;
+	}};
+	Benchmark_Result result;
+
+	//Pool
+	double start{time_since_epoch()};
+	std::vector<Handle> handles;
+	handles.reserve(jobs);
+	for(uint32_t i{}; i < jobs; ++i) handles.push_back(submit(TASK));
+	for(const Handle& h : handles) wait(h);
+	result.pool_jobs_per_second = jobs/(time_since_epoch()-start);
+
+	//A thread per job, with as many in flight as there are workers
+	start = time_since_epoch();
+	std::vector<std::thread> threads(std::max(worker_count, uint8_t{1}));
+	for(uint32_t i{}; i < jobs; ++i)
+	{
+		std::thread& thread{threads[i%threads.size()]};
+		if(thread.joinable()) thread.join();
+		thread = std::thread{TASK, static_cast<uint8_t>(i%threads.size())};
+	}
+	for(std::thread& t : threads) if(t.joinable()) t.join();
+	result.spawn_jobs_per_second = jobs/(time_since_epoch()-start);
+
+	return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+
+namespace Oreginum
+{
+	namespace Job_System
+	{
+		//A job is a task paired with a completion flag, the task receives the index of the
+		//worker running it, which is get_worker_count() for any thread outside the pool
+		struct Job
+		{
+			std::function<void(uint8_t)> task;
+			std::atomic<bool> done{false};
+		};
+		typedef std::shared_ptr<Job> Handle;
+
+		struct Benchmark_Result
+		{
+			double pool_jobs_per_second, spawn_jobs_per_second;
+		};
+
+		void initialize(uint8_t workers = 0);
+		void destroy();
+
+		Handle submit(const std::function<void(uint8_t)>& task);
+		bool is_done(const Handle& job);
+		void wait(const Handle& job);
+		bool help();
+
+		uint8_t get_worker_count();
+		uint8_t get_worker_index();
+
+		//Compares the pool against spawning, and joining, a thread per job
+		Benchmark_Result benchmark(uint32_t jobs, uint32_t iterations_per_job);
+	}
+}
@@ -6,6 +6,7 @@
 #include "Renderable.hpp"
 #include "Window.hpp"
 #include "Camera.hpp"
+#include "Job System.hpp"
 #include "../Tetra/Common.hpp"
 #include "Main Renderer.hpp"
 
@@ -35,6 +36,7 @@ namespace
 		bloom_blur_initial_buffer, bloom_blur_horizontal_buffer, bloom_blur_buffer;
 	std::vector<vk::SubpassDependency> render_pass_dependencies;
 	glm::fmat4 shadow_matrix;
+	glm::fvec3 light_direction;
 
 	struct Lighting_Uniforms
 	{
@@ -42,8 +44,11 @@ namespace
 		glm::fmat4 inverse_view;
 		glm::fmat4 transposed_view;
 		glm::fmat4 shadow_matrix;
+		uint32_t screen_space_ambient_occlusion;
 	};
 	
+	//Ambient occlusion is baked into chunk meshes, SSAO only adds small scale detail on top
+	bool screen_space_ambient_occlusion{false};
 	constexpr uint8_t SSAO_KERNEL_SIZE{8};
 	glm::vec4 ssao_kernel[SSAO_KERNEL_SIZE];
 	struct SSAO_Uniforms
@@ -214,6 +219,13 @@ namespace
 		command_buffers.back().get().beginRenderPass(
 			render_pass_begin_information, vk::SubpassContents::eInline);
 		command_buffers.back().get().bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline.get());
+
+		//Pipelines don't hold a resolution, the pass covers its framebuffer
+		const glm::uvec2& RESOLUTION{framebuffers[framebuffer].get_resolution()};
+		command_buffers.back().get().setViewport(0, vk::Viewport{0, 0,
+			static_cast<float>(RESOLUTION.x), static_cast<float>(RESOLUTION.y), 0, 1});
+		command_buffers.back().get().setScissor(0, vk::Rect2D{{0, 0},
+			vk::Extent2D{RESOLUTION.x, RESOLUTION.y}});
 	}
 
 	void geometry_render(uint8_t index, bool depth_buffer, uint8_t color_attachment_count,
@@ -221,7 +233,7 @@ namespace
 		const std::vector<Oreginum::Vulkan::Framebuffer> framebuffers,
 		const Oreginum::Vulkan::Pipeline& pipeline, bool translucent,
 		std::vector<vk::DescriptorSet> descriptor_sets,
-		bool use_renderable_descriptor = false)
+		bool use_renderable_descriptor = false, bool shadow = false)
 	{
 		//Clear values
 			std::vector<vk::ClearValue> clear_values;
@@ -233,7 +245,7 @@ namespace
 		begin_render_pass(render_pass, clear_values, index, framebuffers, pipeline);
 
 		//Render
-		uint32_t count{};
+		uint32_t count{}, first_indirect_draw{};
 		auto iterator{Oreginum::Renderer_Core::get_renderables().begin()};
 		while(iterator != Oreginum::Renderer_Core::get_renderables().end())
 		{
@@ -247,10 +259,11 @@ namespace
 					pipeline.get_layout(), 0, descriptor_sets,
 					{count*Oreginum::Renderer_Core::get_padded_uniform_size()});
 
-				iterator->second->draw(command_buffers.back());
+				iterator->second->draw(command_buffers.back(), shadow, index, first_indirect_draw);
 
 				if(use_renderable_descriptor) descriptor_sets.pop_back();
 			}
+			first_indirect_draw += iterator->second->get_indirect_draws();
 			++iterator, ++count;
 		}
 		command_buffers.back().get().endRenderPass();
@@ -323,6 +336,7 @@ void Oreginum::Main_Renderer::initialize()
 	position *= 2048;
 	glm::fvec3 world_up{0, 0, 1};
 	glm::fmat4 shadow_view_matrix{glm::lookAt(position, {0, 0, 0}, world_up)};
+	light_direction = glm::normalize(-position);
 
 	shadow_matrix = shadow_projection_matrix*shadow_view_matrix;
 	uint32_t shadow_matrix_size{sizeof(glm::fmat4)};
@@ -419,31 +433,33 @@ void Oreginum::Main_Renderer::create_render_passes_and_pipelines()
 	std::vector<vk::DescriptorSetLayout> translucent_descriptor_set_layout{
 		Renderer_Core::get_uniform_descriptor_set().get_layout()};
 
-	g_buffer_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		g_buffer_render_pass, "G-Buffer Vertex", "G-Buffer Fragment", 0,
-		g_buffer_descriptor_set_layout);
-	shadow_depth_pipeline = Renderer_Core::create_pipeline(SHADOW_DEPTH_BUFFER_RESOLUTION,
-		shadow_depth_render_pass, "Shadow Depth Vertex", "Shadow Depth Fragment", 1,
-		shadow_depth_descriptor_set_layout);
-	translucent_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		translucent_render_pass, "Translucent Vertex", "Translucent Fragment", 2,
-		translucent_descriptor_set_layout);
-	ssao_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		ssao_render_pass, "SSAO Vertex", Vulkan::Swapchain::MULTISAMPLE ?
-		"SSAO Fragment Multisampled" : "SSAO Fragment", 3, {ssao_descriptor_set.get_layout()});
-	ssao_blur_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		ssao_blur_render_pass, "SSAO Blur Vertex", "SSAO Blur Fragment", 4,
-		{ssao_blur_descriptor_set.get_layout()});
-	lighting_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		lighting_render_pass, "Lighting Vertex", Vulkan::Swapchain::MULTISAMPLE ?
+	//Pipelines compile on the workers, this thread helps until every one is done
+	const std::vector<std::function<void()>> PIPELINES{
+		[&]{ g_buffer_pipeline = Renderer_Core::create_pipeline(g_buffer_render_pass,
+			"G-Buffer Vertex", "G-Buffer Fragment", 0, g_buffer_descriptor_set_layout); },
+		[&]{ shadow_depth_pipeline = Renderer_Core::create_pipeline(shadow_depth_render_pass,
+			"Shadow Depth Vertex", "Shadow Depth Fragment", 1,
+			shadow_depth_descriptor_set_layout); },
+		[&]{ translucent_pipeline = Renderer_Core::create_pipeline(translucent_render_pass,
+			"Translucent Vertex", "Translucent Fragment", 2, translucent_descriptor_set_layout); },
+		[&]{ ssao_pipeline = Renderer_Core::create_pipeline(ssao_render_pass, "SSAO Vertex",
+			Vulkan::Swapchain::MULTISAMPLE ? "SSAO Fragment Multisampled" : "SSAO Fragment", 3,
+			{ssao_descriptor_set.get_layout()}); },
+		[&]{ ssao_blur_pipeline = Renderer_Core::create_pipeline(ssao_blur_render_pass,
+			"SSAO Blur Vertex", "SSAO Blur Fragment", 4, {ssao_blur_descriptor_set.get_layout()}); },
+		[&]{ lighting_pipeline = Renderer_Core::create_pipeline(lighting_render_pass,
+			"Lighting Vertex", Vulkan::Swapchain::MULTISAMPLE ?
 			"Lighting Fragment Multisampled" : "Lighting Fragment", 5,
-		{lighting_descriptor_set.get_layout()});
-	bloom_blur_pipeline = Renderer_Core::create_pipeline(bloom_resolution,
-		bloom_blur_render_pass, "Bloom Blur Vertex", "Bloom Blur Fragment", 6,
-		{bloom_blur_descriptor_set.get_layout()});
-	composition_pipeline = Renderer_Core::create_pipeline(Window::get_resolution(),
-		composition_render_pass, "Composition Vertex", "Composition Fragment", 7,
-		{composition_descriptor_set.get_layout()});
+			{lighting_descriptor_set.get_layout()}); },
+		[&]{ bloom_blur_pipeline = Renderer_Core::create_pipeline(bloom_blur_render_pass,
+			"Bloom Blur Vertex", "Bloom Blur Fragment", 6, {bloom_blur_descriptor_set.get_layout()}); },
+		[&]{ composition_pipeline = Renderer_Core::create_pipeline(composition_render_pass,
+			"Composition Vertex", "Composition Fragment", 7,
+			{composition_descriptor_set.get_layout()}); }};
+	std::vector<Job_System::Handle> jobs;
+	for(const std::function<void()>& p : PIPELINES)
+		jobs.push_back(Job_System::submit([&p](uint8_t){ p(); }));
+	for(const Job_System::Handle& j : jobs) Job_System::wait(j);
 }
 
 void Oreginum::Main_Renderer::create_images_and_framebuffers()
@@ -465,6 +481,12 @@ void Oreginum::Main_Renderer::create_images_and_framebuffers()
 	create_image(&translucent_image, Vulkan::Image::LINEAR_FORMAT);
 	create_image(&ssao_image, Vulkan::Image::MONOCHROME_FORMAT, false);
 	create_image(&ssao_blur_image, Vulkan::Image::MONOCHROME_FORMAT, false);
+	//Readable even while SSAO is off, its render pass overwrites it from an undefined layout
+	ssao_blur_image.transition(
+		Renderer_Core::get_temporary_command_buffer(), vk::ImageLayout::eColorAttachmentOptimal,
+		vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eColorAttachmentWrite,
+		vk::AccessFlagBits::eShaderRead, vk::PipelineStageFlagBits::eColorAttachmentOutput,
+		vk::PipelineStageFlagBits::eFragmentShader);
 	create_image(&lighting_image, Vulkan::Image::HDR_FORMAT, false);
 	create_image(&lighting_multisample_image, Vulkan::Image::HDR_FORMAT);
 	create_image(&bloom_blur_horizontal_image, Vulkan::Image::HDR_FORMAT, false, bloom_resolution);
@@ -530,7 +552,8 @@ void Oreginum::Main_Renderer::update_uniforms()
 		glm::fvec4{Oreginum::Camera::get_position(), 0.f},
 		glm::inverse(Oreginum::Camera::get_view()),
 		glm::transpose(Oreginum::Camera::get_view()),
-		shadow_matrix
+		shadow_matrix,
+		screen_space_ambient_occlusion
 	};
 	write_buffer(&lighting_uniforms_buffer, &lighting_uniforms, sizeof(Lighting_Uniforms));
 }
@@ -548,20 +571,31 @@ void Oreginum::Main_Renderer::record()
 		//Normal render
 		if(!Oreginum::Window::is_resizing())
 		{
+			//Uniforms and indirect draws are copied in before every frame
+			vk::MemoryBarrier copy_barrier{vk::AccessFlagBits::eTransferWrite,
+				vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eUniformRead};
+			command_buffers.back().get().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+				vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader |
+				vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags{}, copy_barrier,
+				nullptr, nullptr);
+
 			//Render passes
 			geometry_render(i, true, 4, g_buffer_render_pass, g_buffer_framebuffers, g_buffer_pipeline, 
 				false, {Oreginum::Renderer_Core::get_uniform_descriptor_set().get()}, true);
 			geometry_render(i, true, 0, shadow_depth_render_pass, shadow_depth_framebuffers,
 				shadow_depth_pipeline, false, 
 				{Oreginum::Renderer_Core::get_uniform_descriptor_set().get(),
-				shadow_depth_descriptor_set.get()});
+				shadow_depth_descriptor_set.get()}, false, true);
 			geometry_render(i, false, 2, translucent_render_pass, translucent_framebuffers,
 				translucent_pipeline, true, {Oreginum::Renderer_Core::get_uniform_descriptor_set().get()});
 		
-			deferred_render(i, 1, ssao_render_pass, ssao_framebuffers,
-				ssao_pipeline, ssao_descriptor_set.get());
-			deferred_render(i, 1, ssao_blur_render_pass, ssao_blur_framebuffers,
-				ssao_blur_pipeline, ssao_blur_descriptor_set.get());
+			if(screen_space_ambient_occlusion)
+			{
+				deferred_render(i, 1, ssao_render_pass, ssao_framebuffers,
+					ssao_pipeline, ssao_descriptor_set.get());
+				deferred_render(i, 1, ssao_blur_render_pass, ssao_blur_framebuffers,
+					ssao_blur_pipeline, ssao_blur_descriptor_set.get());
+			}
 			deferred_render(i, 2, lighting_render_pass, lighting_framebuffers,
 				lighting_pipeline, lighting_descriptor_set.get());
 
@@ -614,6 +648,21 @@ void Oreginum::Main_Renderer::record()
 void Oreginum::Main_Renderer::reinitialize_swapchain()
 { swapchain.reinitialize(Renderer_Core::get_device(), Renderer_Core::get_temporary_command_buffer()); }
 
+glm::fvec3 Oreginum::Main_Renderer::get_light_direction(){ return light_direction; }
+
+uint8_t Oreginum::Main_Renderer::get_image_count()
+{ return static_cast<uint8_t>(swapchain.get_images().size()); }
+
+void Oreginum::Main_Renderer::set_screen_space_ambient_occlusion(bool enabled)
+{
+	if(enabled == screen_space_ambient_occlusion) return;
+	screen_space_ambient_occlusion = enabled;
+	Renderer_Core::request_record();
+}
+
+bool Oreginum::Main_Renderer::get_screen_space_ambient_occlusion()
+{ return screen_space_ambient_occlusion; }
+
 void Oreginum::Main_Renderer::render()
 {
 	//Get swapchain image
@@ -623,10 +672,11 @@ void Oreginum::Main_Renderer::render()
 	if(result == vk::Result::eSuboptimalKHR || result == vk::Result::eErrorOutOfDateKHR)
 		Core::error("Could not aquire a Vulkan swapchain image.");
 
-	//Submit render commands
+	//Submit render commands, after the indirect draws the image's commands read
+	Renderer_Core::write_indirect_draws(image_index);
 	Renderer_Core::submit_command_buffers({command_buffers[image_index].get()},
 		{image_available.get()}, {vk::PipelineStageFlagBits::eColorAttachmentOutput},
-		{render_finished.get()});
+		{render_finished.get()}, Renderer_Core::begin_frame());
 
 	//Present swapchain image
 	std::array<vk::Semaphore, 1> present_wait_semaphores{render_finished.get()};
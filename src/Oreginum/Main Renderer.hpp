@@ -13,6 +13,10 @@ namespace Oreginum
 		void write_descriptor_sets();
 		void update_uniforms();
 		void record();
+		glm::fvec3 get_light_direction();
+		uint8_t get_image_count();
+		void set_screen_space_ambient_occlusion(bool enabled);
+		bool get_screen_space_ambient_occlusion();
 
 		void reinitialize_swapchain();
 	};
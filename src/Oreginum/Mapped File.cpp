@@ -0,0 +1,53 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "Mapped File.hpp"
+
+#ifdef _WIN32
+Oreginum::Mapped_File::Mapped_File(const std::string& path)
+{
+	//Writers append to the file while it is mapped, so it is shared for writing
+	file = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if(file == INVALID_HANDLE_VALUE) return;
+	LARGE_INTEGER file_size;
+	if(!GetFileSizeEx(file, &file_size) || !file_size.QuadPart) return;
+
+	mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if(!mapping) return;
+	data = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if(data) size = static_cast<size_t>(file_size.QuadPart);
+}
+
+Oreginum::Mapped_File::~Mapped_File()
+{
+	if(data) UnmapViewOfFile(data);
+	if(mapping) CloseHandle(mapping);
+	if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+}
+#else
+Oreginum::Mapped_File::Mapped_File(const std::string& path)
+{
+	const int FILE{open(path.c_str(), O_RDONLY)};
+	if(FILE < 0) return;
+	struct stat file_status;
+	if(!fstat(FILE, &file_status) && file_status.st_size)
+	{
+		void *mapped{mmap(nullptr, file_status.st_size, PROT_READ, MAP_SHARED, FILE, 0)};
+		if(mapped != MAP_FAILED)
+			data = static_cast<const uint8_t *>(mapped), size = file_status.st_size;
+	}
+
+	//The mapping stays valid once the descriptor is closed
+	close(FILE);
+}
+
+Oreginum::Mapped_File::~Mapped_File()
+{ if(data) munmap(const_cast<uint8_t *>(data), size); }
+#endif
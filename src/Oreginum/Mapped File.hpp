@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Oreginum
+{
+	//A read only memory mapping of a whole file, empty when the file is missing or empty.
+	//The mapping covers the file's size when it was opened, later appends need a new one.
+	class Mapped_File
+	{
+	public:
+		Mapped_File(const std::string& path);
+		Mapped_File(const Mapped_File&) = delete;
+		Mapped_File& operator=(const Mapped_File&) = delete;
+		~Mapped_File();
+
+		const uint8_t *get_data() const { return data; }
+		size_t get_size() const { return size; }
+
+	private:
+		const uint8_t *data{};
+		size_t size{};
+	#ifdef _WIN32
+		void *file, *mapping{};
+	#endif
+	};
+}
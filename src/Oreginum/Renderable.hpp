@@ -21,8 +21,13 @@ namespace Oreginum
 			Oreginum::Renderer_Core::Renderer_Type::MAIN);
 		virtual void initialize_descriptor(){};
 		virtual const Oreginum::Vulkan::Descriptor_Set& get_descriptor_set() = 0;
-		virtual void draw(const Vulkan::Command_Buffer& command_buffer){};
+		virtual void draw(const Vulkan::Command_Buffer& command_buffer, bool shadow,
+			uint8_t image, uint32_t first_indirect_draw){};
 		virtual void update() = 0;
+		//Draws read from the renderer's indirect buffer of the swapchain image, which is
+		//rewritten every frame so they change without recording command buffers again
+		virtual uint32_t get_indirect_draws() const { return 0; }
+		virtual void write_indirect_draws(vk::DrawIndexedIndirectCommand *draws) const {}
 
 		virtual const void* get_uniforms() const = 0;
 		virtual const uint32_t get_uniforms_size() const { return sizeof(Uniforms); };
@@ -1,4 +1,6 @@
 #include <mutex>
+#include <limits>
+#include <chrono>
 #include "Core.hpp"
 #include "Window.hpp"
 #include "Renderable.hpp"
@@ -14,40 +16,68 @@ namespace
 	Oreginum::Vulkan::Command_Buffer temporary_command_buffer;
 	Oreginum::Vulkan::Descriptor_Pool static_descriptor_pool, descriptor_pool;
 	Oreginum::Vulkan::Command_Pool command_pool;
+	Oreginum::Vulkan::Pipeline_Cache pipeline_cache;
 	uint32_t uniform_size, padded_uniform_size, uniform_buffer_size;
 	std::map<Oreginum::Renderer_Core::Key, Oreginum::Renderable *> renderables;
 	Oreginum::Vulkan::Descriptor_Set uniform_descriptor_set, texture_descriptor_set;
 	Oreginum::Vulkan::Buffer uniform_buffer;
+	//Frames in flight render other swapchain images, so each image has its own indirect
+	//buffer, along with the number of the frame that last read it
+	std::vector<Oreginum::Vulkan::Buffer> indirect_buffers;
+	std::vector<uint64_t> indirect_buffer_frames;
+	uint32_t indirect_draws;
+	std::vector<vk::DrawIndexedIndirectCommand> indirect_draw_data;
 	bool rerecord{true};
+	float record_seconds;
 	uint32_t id;
     std::mutex render_mutex;
 	uint32_t minimum_offset;
+	constexpr uint8_t FRAME_FENCES{4};
+	Oreginum::Vulkan::Fence frame_fences[FRAME_FENCES];
+	uint64_t submitted_frames, completed_frames;
+	const std::string PIPELINE_CACHE_PATH{"Pipeline Cache.bin"};
+
+	void update_completed_frames()
+	{
+		while(completed_frames < submitted_frames && device->get().getFenceStatus(
+			frame_fences[completed_frames%FRAME_FENCES].get()) == vk::Result::eSuccess)
+			++completed_frames;
+	}
+
+	void wait_for_frame(uint64_t frame)
+	{
+		//Frames complete in order, so every frame up to it is waited on in turn
+		update_completed_frames();
+		for(; completed_frames < frame; ++completed_frames)
+			device->get().waitForFences({frame_fences[completed_frames%FRAME_FENCES].get()},
+				VK_TRUE, std::numeric_limits<uint64_t>::max());
+	}
 }
 
 void Oreginum::Renderer_Core::submit_command_buffers(
 	const std::vector<vk::CommandBuffer>& command_buffers,
 	const std::vector<vk::Semaphore>& wait_semaphores,
 	const std::vector<vk::PipelineStageFlags>& wait_stages,
-	const std::vector<vk::Semaphore>& signal_semaphores)
+	const std::vector<vk::Semaphore>& signal_semaphores, const vk::Fence& fence)
 {
 	vk::SubmitInfo submit_information{static_cast<uint32_t>(wait_semaphores.size()),
 		wait_semaphores.data(), wait_stages.data(), static_cast<uint32_t>(
 			command_buffers.size()), command_buffers.data(),
 		static_cast<uint32_t>(signal_semaphores.size()), signal_semaphores.data()};
 	if(Oreginum::Renderer_Core::get_device()->get_graphics_queue().submit(
-        submit_information, nullptr) != vk::Result::eSuccess)
+        submit_information, fence) != vk::Result::eSuccess)
 		Oreginum::Core::error("Could not submit buffer renderer Vulkan command buffer.");
 }
 
 Oreginum::Vulkan::Pipeline Oreginum::Renderer_Core::create_pipeline(
-	const glm::ivec2& resolution, const Vulkan::Render_Pass& render_pass,
-	const std::string& vertex, const std::string& fragment, uint8_t render_pass_number,
+	const Vulkan::Render_Pass& render_pass, const std::string& vertex,
+	const std::string& fragment, uint8_t render_pass_number,
 	const std::vector<vk::DescriptorSetLayout>& descriptor_layouts,
 	const Vulkan::Pipeline& base)
 {
 	Vulkan::Shader shader{device, {{vertex, vk::ShaderStageFlagBits::eVertex},
 		{fragment, vk::ShaderStageFlagBits::eFragment}}};
-	return {device, resolution, render_pass, shader,
+	return {device, pipeline_cache, render_pass, shader,
 		descriptor_layouts, render_pass_number, base};
 }
 
@@ -71,6 +101,8 @@ void Oreginum::Renderer_Core::initialize()
 		vk::CommandPoolCreateFlagBits::eResetCommandBuffer};
 	temporary_command_buffer = {device, temporary_command_pool};
 	command_pool = {device, device->get_graphics_queue_family_index()};
+	pipeline_cache = {device, PIPELINE_CACHE_PATH};
+	for(Vulkan::Fence& f : frame_fences) f = {device};
 
 	//Calculate uniform buffer padding
 	minimum_offset = static_cast<uint32_t>(device->
@@ -89,8 +121,9 @@ void Oreginum::Renderer_Core::initialize()
 	create_uniform_buffer();
 	create_descriptors();
 
-	//Call renderers to initialize
+	//Call renderers to initialize, then keep the pipelines they compiled for the next run
 	Main_Renderer::initialize();
+	pipeline_cache.save();
 }
 
 uint32_t Oreginum::Renderer_Core::add(Renderer_Type renderer_type, Renderable *renderable)
@@ -105,6 +138,30 @@ void Oreginum::Renderer_Core::remove(Renderer_Type renderer_type, uint32_t id)
 
 void Oreginum::Renderer_Core::clear(){ renderables.clear(), rerecord = true; }
 
+void Oreginum::Renderer_Core::request_record(){ rerecord = true; }
+
+float Oreginum::Renderer_Core::get_record_seconds(){ return record_seconds; }
+
+vk::Fence Oreginum::Renderer_Core::begin_frame()
+{
+	//Reuse the oldest fence, waiting on its frame when the ring is full
+	const Vulkan::Fence& fence{frame_fences[submitted_frames%FRAME_FENCES]};
+	if(submitted_frames-completed_frames == FRAME_FENCES)
+		device->get().waitForFences({fence.get()}, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	update_completed_frames();
+	device->get().resetFences({fence.get()});
+	++submitted_frames;
+	return fence.get();
+}
+
+uint64_t Oreginum::Renderer_Core::get_submitted_frames(){ return submitted_frames; }
+
+uint64_t Oreginum::Renderer_Core::get_completed_frames()
+{
+	update_completed_frames();
+	return completed_frames;
+}
+
 void Oreginum::Renderer_Core::create_uniform_buffer()
 {
 	if(!renderables.empty())
@@ -115,6 +172,18 @@ void Oreginum::Renderer_Core::create_uniform_buffer()
 	}
 }
 
+void Oreginum::Renderer_Core::create_indirect_buffer()
+{
+	indirect_draws = 0;
+	for(const auto& r : renderables) indirect_draws += r.second->get_indirect_draws();
+	indirect_draw_data.resize(indirect_draws);
+	indirect_buffers.resize(Main_Renderer::get_image_count());
+	indirect_buffer_frames.assign(indirect_buffers.size(), 0);
+	if(indirect_draws) for(Vulkan::Buffer& b : indirect_buffers) b = {device,
+		temporary_command_buffer, vk::BufferUsageFlagBits::eIndirectBuffer,
+		indirect_draws*sizeof(vk::DrawIndexedIndirectCommand)};
+}
+
 void Oreginum::Renderer_Core::create_descriptors()
 {
 	//Create descriptor pool
@@ -133,18 +202,23 @@ void Oreginum::Renderer_Core::create_descriptors()
 
 void Oreginum::Renderer_Core::record()
 {
+	const std::chrono::steady_clock::time_point START{std::chrono::steady_clock::now()};
 	device->get().waitIdle();
 
 	rerecord = false;
 	create_uniform_buffer();
+	create_indirect_buffer();
 	create_descriptors();
 
 	//Call renderers to record command buffers
 	Main_Renderer::record();
+	record_seconds += std::chrono::duration<float>(std::chrono::steady_clock::now()-START).count();
 }
 
 void Oreginum::Renderer_Core::update()
 {
+	record_seconds = 0;
+
 	//Handle window resizing
 	if(Window::is_resizing())
 	{
@@ -161,10 +235,10 @@ void Oreginum::Renderer_Core::update()
 
 	if(Window::is_resizing()) return;
 
+	//Pipelines take the viewport when recording, only the attachments change size
 	if(Window::was_resized())
 	{
 		device->get().waitIdle();
-		Main_Renderer::create_render_passes_and_pipelines();
 		Main_Renderer::create_images_and_framebuffers();
 		Main_Renderer::write_descriptor_sets();
 	}
@@ -188,9 +262,29 @@ void Oreginum::Renderer_Core::update()
 		std::free(buffer);
 	}
 
+	//Then the indirect draws, in the order renderables were recorded in, they are copied
+	//in once the frame's swapchain image is known
+	uint32_t first{};
+	for(const auto& r : renderables)
+	{
+		r.second->write_indirect_draws(indirect_draw_data.data()+first);
+		first += r.second->get_indirect_draws();
+	}
+
 	Main_Renderer::update_uniforms();
 }
 
+void Oreginum::Renderer_Core::write_indirect_draws(uint32_t image)
+{
+	//The buffer may still be read by the last frame that rendered the image, the frame
+	//about to be submitted reads it next
+	if(!indirect_draws || image >= indirect_buffers.size()) return;
+	wait_for_frame(indirect_buffer_frames[image]);
+	indirect_buffers[image].write(indirect_draw_data.data(),
+		indirect_draws*sizeof(vk::DrawIndexedIndirectCommand));
+	indirect_buffer_frames[image] = submitted_frames+1;
+}
+
 std::shared_ptr<Oreginum::Vulkan::Instance> Oreginum::Renderer_Core::get_instance()
 { return instance; }
 std::shared_ptr<Oreginum::Vulkan::Surface> Oreginum::Renderer_Core::get_surface(){ return surface; }
@@ -204,6 +298,8 @@ const Oreginum::Vulkan::Descriptor_Pool& Oreginum::Renderer_Core::get_static_des
 const std::map<Oreginum::Renderer_Core::Key, Oreginum::Renderable *>&
 	Oreginum::Renderer_Core::get_renderables(){ return renderables; }
 uint32_t Oreginum::Renderer_Core::get_padded_uniform_size(){ return padded_uniform_size; }
+const Oreginum::Vulkan::Buffer& Oreginum::Renderer_Core::get_indirect_buffer(uint32_t image)
+{ return indirect_buffers[image]; }
 Oreginum::Vulkan::Descriptor_Set Oreginum::Renderer_Core::get_uniform_descriptor_set()
 { return uniform_descriptor_set; }
 Oreginum::Vulkan::Descriptor_Set Oreginum::Renderer_Core::get_texture_descriptor_set()
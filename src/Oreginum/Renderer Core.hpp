@@ -6,6 +6,7 @@
 #include "../Vulkan/Command Pool.hpp"
 #include "../Vulkan/Framebuffer.hpp"
 #include "../Vulkan/Semaphore.hpp"
+#include "../Vulkan/Fence.hpp"
 
 namespace Oreginum
 {
@@ -27,19 +28,34 @@ namespace Oreginum
 		void initialize();
 		uint32_t add(Renderer_Type renderer_type, Renderable *renderable);
 		void remove(Renderer_Type renderer_type, uint32_t id);
-		Vulkan::Pipeline create_pipeline(const glm::ivec2& resolution,
-			const Vulkan::Render_Pass& render_pass, const std::string& vertex,
+		//Safe to call from several threads, pipelines share the cache saved by initialize
+		Vulkan::Pipeline create_pipeline(const Vulkan::Render_Pass& render_pass,
+			const std::string& vertex,
 			const std::string& fragment, uint8_t render_pass_number,
 			const std::vector<vk::DescriptorSetLayout>& descriptor_layouts,
 			const Vulkan::Pipeline& base = {});
 		void submit_command_buffers(const std::vector<vk::CommandBuffer>& command_buffers,
 			const std::vector<vk::Semaphore>& wait_semaphores = {},
 			const std::vector<vk::PipelineStageFlags>& wait_stages = {},
-			const std::vector<vk::Semaphore>& signal_semaphores = {});
+			const std::vector<vk::Semaphore>& signal_semaphores = {},
+			const vk::Fence& fence = nullptr);
 		void update();
+		//Copies this frame's indirect draws into the buffer the image's commands read,
+		//once the last frame that read it is done
+		void write_indirect_draws(uint32_t image);
+		void request_record();
+		//Seconds the last update spent waiting for the device and recording command buffers
+		float get_record_seconds();
+
+		//Frames are numbered as they are submitted, anything a frame could reference
+		//may be freed once get_completed_frames() passes get_submitted_frames() at removal
+		vk::Fence begin_frame();
+		uint64_t get_submitted_frames();
+		uint64_t get_completed_frames();
 
 		void clear();
 		void create_uniform_buffer();
+		void create_indirect_buffer();
 		void create_descriptors();
 		void record();
 
@@ -52,6 +68,7 @@ namespace Oreginum
 		const std::map<Oreginum::Renderer_Core::Key, Oreginum::Renderable *>& get_renderables();
 		uint32_t get_padded_uniform_size();
 		uint32_t get_padded_uniform_size(uint32_t uniform_size);
+		const Vulkan::Buffer& get_indirect_buffer(uint32_t image);
 		Vulkan::Descriptor_Set get_uniform_descriptor_set();
 		Vulkan::Descriptor_Set get_texture_descriptor_set();
 		const Vulkan::Command_Buffer& get_temporary_command_buffer();
@@ -0,0 +1,58 @@
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#endif
+#include <memory>
+#include <unordered_map>
+#include "Mapped File.hpp"
+#include "Resource Pack.hpp"
+
+namespace
+{
+	std::unique_ptr<Oreginum::Mapped_File> file;
+	std::unordered_map<std::string, Oreginum::Resource_Pack::Span> resources;
+
+	bool load(const uint8_t *data, size_t size)
+	{
+		using namespace Oreginum::Resource_Pack;
+		if(!data || size < sizeof(Header)) return false;
+		const Header& HEADER{*reinterpret_cast<const Header *>(data)};
+		const uint64_t NAMES{sizeof(Header)+uint64_t{HEADER.entries}*sizeof(Entry)};
+		if(HEADER.magic != MAGIC || HEADER.version != VERSION ||
+			NAMES+HEADER.names_size > size) return false;
+
+		const Entry *entries{reinterpret_cast<const Entry *>(data+sizeof(Header))};
+		const char *names{reinterpret_cast<const char *>(data+NAMES)};
+		for(uint32_t i{}; i < HEADER.entries; ++i)
+		{
+			const Entry& e{entries[i]};
+			if(uint64_t{e.name_offset}+e.name_length > HEADER.names_size ||
+				e.offset > size || e.size > size-e.offset){ resources.clear(); return false; }
+			resources[std::string(names+e.name_offset, e.name_length)] =
+				{data+e.offset, static_cast<size_t>(e.size)};
+		}
+		return true;
+	}
+}
+
+void Oreginum::Resource_Pack::initialize(const std::string& path)
+{
+	if(!resources.empty()) return;
+
+#ifdef _WIN32
+	//A pack linked in by Resources.rc is mapped with the executable
+	HRSRC resource{FindResource(NULL, "RESOURCE_PACK", RT_RCDATA)};
+	HGLOBAL handle{resource ? LoadResource(NULL, resource) : NULL};
+	if(handle && load(static_cast<const uint8_t *>(LockResource(handle)),
+		SizeofResource(NULL, resource))) return;
+#endif
+
+	file = std::make_unique<Mapped_File>(path);
+	if(!load(file->get_data(), file->get_size())) file.reset();
+}
+
+Oreginum::Resource_Pack::Span Oreginum::Resource_Pack::get(const std::string& name)
+{
+	const auto RESOURCE{resources.find(name)};
+	return RESOURCE == resources.end() ? Span{} : RESOURCE->second;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Oreginum::Resource_Pack
+{
+	//An archive of resource files, named by their path under Resources with forward slashes.
+	//After the header come its entries, then their names, then each file's data from its
+	//offset in the archive, aligned so SPIR-V and texel data can be used in place.
+	constexpr uint32_t MAGIC{0x4B434150}, VERSION{1}, ALIGNMENT{16};
+
+	struct Header
+	{
+		uint32_t magic, version, entries, names_size;
+	};
+
+	struct Entry
+	{
+		uint64_t offset, size;
+		uint32_t name_offset, name_length;
+	};
+
+	//Memory inside the pack, null when a resource isn't packed
+	struct Span
+	{
+		const uint8_t *data;
+		size_t size;
+	};
+
+	//Uses the pack linked into the executable, or maps the one at path, once for the run
+	void initialize(const std::string& path);
+
+	Span get(const std::string& name);
+}
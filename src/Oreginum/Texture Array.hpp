@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace Oreginum::Texture_Array
+{
+	//A texture array stored with every mip level of 8 bit RGBA texels, so it loads without
+	//decoding images or generating mipmaps. After the header each level holds every layer
+	//in order, starting at its offset in the level table, largest level first.
+	constexpr uint32_t MAGIC{0x59525241}, VERSION{1}, MAXIMUM_LEVELS{16};
+
+	//Matches Texture::Format, linear textures are stored as sRGB and filtered in linear space
+	enum Format : uint32_t{RGB, LINEAR};
+
+	struct Header
+	{
+		uint32_t magic, version, format, width, height, layers, levels;
+		uint32_t level_offsets[MAXIMUM_LEVELS];
+	};
+
+	inline uint32_t get_level_size(const Header& header, uint32_t level)
+	{
+		return std::max(header.width>>level, 1U)*std::max(header.height>>level, 1U)*
+			4*header.layers;
+	}
+
+	//Whether data holds a complete texture array of the given layers
+	inline bool is_valid(const uint8_t *data, size_t size, uint32_t layers)
+	{
+		if(!data || size < sizeof(Header)) return false;
+		const Header& HEADER{*reinterpret_cast<const Header *>(data)};
+		if(HEADER.magic != MAGIC || HEADER.version != VERSION || HEADER.format > LINEAR ||
+			!HEADER.width || !HEADER.height || HEADER.layers != layers ||
+			!HEADER.levels || HEADER.levels > MAXIMUM_LEVELS) return false;
+		for(uint32_t i{}; i < HEADER.levels; ++i)
+			if(HEADER.level_offsets[i]%4 || uint64_t{HEADER.level_offsets[i]}+
+				get_level_size(HEADER, i) > size) return false;
+		return true;
+	}
+}
@@ -1,6 +1,7 @@
 #include "Core.hpp"
 #include "Renderer Core.hpp"
 #include "Texture.hpp"
+#include "Texture Array.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
@@ -32,6 +33,23 @@ Oreginum::Texture::Texture(const std::vector<std::string>& paths, const Vulkan::
 	for(void *d : datas) stbi_image_free(d);
 }
 
+Oreginum::Texture::Texture(const uint8_t *texture_array, size_t size,
+	const Vulkan::Sampler& sampler)
+{
+	static_assert(Texture_Array::RGB == RGB && Texture_Array::LINEAR == LINEAR,
+		"Texture array formats match texture formats");
+
+	//The whole file is staged, level offsets are from its start
+	const Texture_Array::Header& HEADER{
+		*reinterpret_cast<const Texture_Array::Header *>(texture_array)};
+	type = static_cast<Format>(HEADER.format);
+	resolution = {HEADER.width, HEADER.height};
+	image = Vulkan::Image{Renderer_Core::get_device(), sampler,
+		Renderer_Core::get_temporary_command_buffer(), resolution, HEADER.layers,
+		texture_array, size, std::vector<size_t>(
+		HEADER.level_offsets, HEADER.level_offsets+HEADER.levels), get_format()};
+}
+
 vk::Format Oreginum::Texture::get_format()
 {
 	return (type == RGB) ? Vulkan::Image::RGB_FORMAT : (type == LINEAR) ?
@@ -16,6 +16,8 @@ namespace Oreginum
 			: Texture(std::vector<std::string>{path}, sampler, type){}
 		Texture(const std::vector<std::string>& paths, const Vulkan::Sampler& sampler,
 			Format type = RGB, bool cubemap = false);
+		//A texture array built offline with its mipmaps, checked with Texture_Array::is_valid
+		Texture(const uint8_t *texture_array, size_t size, const Vulkan::Sampler& sampler);
 
 		const Vulkan::Image& get_image() const { return image; }
 
@@ -0,0 +1,524 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <fstream>
+#include <cmath>
+#include <filesystem>
+#include <atomic>
+#include "../Oreginum/Job System.hpp"
+#include "../Infinitus/Generator.hpp"
+#include "../Infinitus/Region Store.hpp"
+#include "../Infinitus/Chunk View.hpp"
+#include "../Oreginum/Texture Array.hpp"
+#include "../Oreginum/Resource Pack.hpp"
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace
+{
+	typedef std::unordered_map<glm::ivec3, Tetra::Chunk *, Tetra::ivec3_hash> Chunk_Map;
+
+	void run_jobs(const std::vector<Tetra::Chunk *>& chunks,
+		const std::function<void(Tetra::Chunk *)>& task)
+	{
+		std::vector<Oreginum::Job_System::Handle> jobs;
+		jobs.reserve(chunks.size());
+		for(Tetra::Chunk *c : chunks)
+			jobs.push_back(Oreginum::Job_System::submit([&task, c](uint8_t){ task(c); }));
+		for(const Oreginum::Job_System::Handle& j : jobs) Oreginum::Job_System::wait(j);
+	}
+
+	glm::ivec3 get_chunk_position(const Tetra::Chunk *chunk)
+	{ return glm::ivec3{glm::floor(chunk->get_translation()/static_cast<float>(Tetra::CHUNK_SIZE))}; }
+
+	//Generates and stores every chunk in a box, a z slab at a time. Chunks take trees from
+	//their neighbours, so the box is generated one chunk wider than it is stored, and a
+	//slab is stored once the slabs on both sides have finished their second pass. Stored
+	//chunks are skipped, so an interrupted run resumes where it stopped.
+	int pregen(int argument_count, char **arguments)
+	{
+		if(argument_count < 6)
+		{
+			printf("Usage: pregen <minimum x y z> <maximum x y z> [-seed <seed>] "
+				"[-directory <world directory>]\n");
+			return 1;
+		}
+		glm::ivec3 minimum, maximum;
+		for(uint8_t axis{}; axis < 3; ++axis)
+			minimum[axis] = std::atoi(arguments[axis]),
+			maximum[axis] = std::atoi(arguments[axis+3]);
+		maximum = glm::max(minimum, maximum);
+		uint32_t seed{Tetra::SEED};
+		std::string directory{"World"};
+		for(int i{6}; i+1 < argument_count; i += 2)
+			if(!std::strcmp(arguments[i], "-seed"))
+				seed = static_cast<uint32_t>(std::strtoul(arguments[i+1], nullptr, 10));
+			else if(!std::strcmp(arguments[i], "-directory")) directory = arguments[i+1];
+
+		Tetra::Region_Store store{directory, seed};
+		if(store.get_seed() != seed)
+			printf("%s was generated with seed %u, which is used instead\n",
+				directory.c_str(), store.get_seed());
+
+		//Chunks are only added and removed between passes, workers just look them up
+		Chunk_Map chunks;
+		Tetra::Generator generator{store.get_seed(), [&chunks](const glm::ivec3& chunk_position)
+			{
+				const auto CHUNK{chunks.find(chunk_position)};
+				return CHUNK == chunks.end() ? nullptr : CHUNK->second;
+			}};
+
+		//A slab is generated while a stored slab next to it, or itself, is missing a chunk
+		const auto IS_STORED = [&](int z)
+		{
+			if(z < minimum.z || z > maximum.z) return true;
+			for(int y{minimum.y}; y <= maximum.y; ++y)
+				for(int x{minimum.x}; x <= maximum.x; ++x)
+					if(!store.contains({x, y, z})) return false;
+			return true;
+		};
+		const auto IS_NEEDED = [&](int z){ return z >= minimum.z-1 && z <= maximum.z+1 &&
+			!(IS_STORED(z-1) && IS_STORED(z) && IS_STORED(z+1)); };
+		const auto GET_SLAB = [&](int z, glm::ivec3 border)
+		{
+			std::vector<Tetra::Chunk *> slab;
+			for(int y{minimum.y-border.y}; y <= maximum.y+border.y; ++y)
+				for(int x{minimum.x-border.x}; x <= maximum.x+border.x; ++x)
+				{
+					const auto CHUNK{chunks.find({x, y, z})};
+					if(CHUNK != chunks.end()) slab.push_back(CHUNK->second);
+				}
+			return slab;
+		};
+
+		Oreginum::Job_System::initialize();
+		const std::chrono::steady_clock::time_point START{std::chrono::steady_clock::now()};
+		size_t stored{};
+		for(int z{minimum.z-1}; z <= maximum.z+3; ++z)
+		{
+			//First pass of the newest slab
+			if(IS_NEEDED(z))
+			{
+				for(int y{minimum.y-1}; y <= maximum.y+1; ++y)
+					for(int x{minimum.x-1}; x <= maximum.x+1; ++x)
+						chunks[{x, y, z}] = new Tetra::Chunk(glm::fvec3(glm::ivec3{x, y, z}*
+							static_cast<int>(Tetra::CHUNK_SIZE)), glm::fvec3(0),
+							glm::u8vec3(x&255, y&255, z&255));
+				run_jobs(GET_SLAB(z, glm::ivec3{1}), [&generator](Tetra::Chunk *chunk)
+					{ generator.populate_chunk_pass_1(chunk); });
+			}
+
+			//Second pass of the slab behind it, in four phases of chunks that are never
+			//neighbours, so trees are written in the same order on every run
+			if(IS_NEEDED(z-1)) for(uint8_t phase{}; phase < 4; ++phase)
+			{
+				std::vector<Tetra::Chunk *> slab{GET_SLAB(z-1, glm::ivec3{1})};
+				slab.erase(std::remove_if(slab.begin(), slab.end(), [phase](Tetra::Chunk *c)
+					{
+						const glm::ivec3 POSITION{get_chunk_position(c)};
+						return (POSITION.x&1)+(POSITION.y&1)*2 != phase;
+					}), slab.end());
+				run_jobs(slab, [&generator](Tetra::Chunk *chunk)
+					{ generator.populate_chunk_pass_2(chunk); });
+			}
+
+			//Store the slab behind that, nothing writes into it anymore, then free it
+			if(z-2 >= minimum.z && z-2 <= maximum.z)
+			{
+				std::vector<Tetra::Chunk *> slab{GET_SLAB(z-2, glm::ivec3{0})};
+				slab.erase(std::remove_if(slab.begin(), slab.end(), [&store](Tetra::Chunk *c)
+					{ return store.contains(get_chunk_position(c)); }), slab.end());
+				run_jobs(slab, [&store](Tetra::Chunk *chunk)
+					{ store.write(get_chunk_position(chunk), chunk->encode()); });
+				stored += slab.size();
+
+				const float SECONDS{std::chrono::duration<float>(
+					std::chrono::steady_clock::now()-START).count()};
+				printf("Slab %d of %d-%d: %zu chunks stored, %.1f chunks/s\n", z-2,
+					minimum.z, maximum.z, stored, SECONDS > 0 ? stored/SECONDS : 0.f);
+			}
+			for(Tetra::Chunk *c : GET_SLAB(z-2, glm::ivec3{1}))
+				chunks.erase(get_chunk_position(c)), delete c;
+		}
+
+		Oreginum::Job_System::destroy();
+		return 0;
+	}
+
+	//Checks every stored chunk in a box, reading it in place through a chunk view instead
+	//of decoding it, and meshes it at a level of detail as far field meshing would
+	int verify(int argument_count, char **arguments)
+	{
+		if(argument_count < 6)
+		{
+			printf("Usage: verify <minimum x y z> <maximum x y z> [-lod <level of detail>] "
+				"[-directory <world directory>]\n");
+			return 1;
+		}
+		glm::ivec3 minimum, maximum;
+		for(uint8_t axis{}; axis < 3; ++axis)
+			minimum[axis] = std::atoi(arguments[axis]),
+			maximum[axis] = std::atoi(arguments[axis+3]);
+		maximum = glm::max(minimum, maximum);
+		uint8_t lod{2};
+		std::string directory{"World"};
+		for(int i{6}; i+1 < argument_count; i += 2)
+			if(!std::strcmp(arguments[i], "-lod"))
+				lod = static_cast<uint8_t>(std::clamp(std::atoi(arguments[i+1]), 0,
+					Tetra::Chunk::LODS-1));
+			else if(!std::strcmp(arguments[i], "-directory")) directory = arguments[i+1];
+		if(!std::filesystem::exists(directory))
+		{
+			printf("%s does not exist\n", directory.c_str());
+			return 1;
+		}
+
+		Tetra::Region_Store store{directory, Tetra::SEED};
+		Oreginum::Job_System::initialize();
+		std::vector<Tetra::Mesh_Arena> arenas(Oreginum::Job_System::get_worker_count()+1U);
+		std::atomic<uint64_t> checked{}, invalid{}, solid{}, faces{};
+		const std::chrono::steady_clock::time_point START{std::chrono::steady_clock::now()};
+		std::vector<Oreginum::Job_System::Handle> jobs;
+		for(int z{minimum.z}; z <= maximum.z; ++z)
+			for(int y{minimum.y}; y <= maximum.y; ++y)
+				for(int x{minimum.x}; x <= maximum.x; ++x)
+					if(store.contains({x, y, z})) jobs.push_back(Oreginum::Job_System::submit(
+						[&, POSITION = glm::ivec3{x, y, z}](uint8_t worker)
+					{
+						Tetra::Mesh_Arena *arena{&arenas[worker]};
+						const bool VALID{store.read(POSITION, [&](const uint8_t *data, size_t size)
+							{
+								const Tetra::Chunk_View VIEW{data, size};
+								if(!VIEW.is_valid()) return false;
+								uint64_t chunk_solid{};
+								VIEW.for_each_run([&](uint32_t, uint32_t count, uint8_t material)
+									{ if(material) chunk_solid += count; });
+								solid += chunk_solid;
+								if(lod && Tetra::Chunk::create_mesh(arena, VIEW, lod))
+									for(const Tetra::Mesh_Data& m : arena->mesh_datas) faces += m.face;
+								return true;
+							})};
+						++checked;
+						if(!VALID)
+						{
+							++invalid;
+							printf("Chunk %d %d %d is corrupt\n", POSITION.x, POSITION.y, POSITION.z);
+						}
+					}));
+		for(const Oreginum::Job_System::Handle& j : jobs) Oreginum::Job_System::wait(j);
+		Oreginum::Job_System::destroy();
+
+		const float SECONDS{std::chrono::duration<float>(
+			std::chrono::steady_clock::now()-START).count()};
+		printf("%llu chunks read, %llu corrupt, %.1f%% solid, %llu faces at level of detail %u, "
+			"%.1f chunks/s\n", static_cast<unsigned long long>(checked.load()),
+			static_cast<unsigned long long>(invalid.load()), checked ? solid*100./
+			(checked*Tetra::CHUNK_SIZE_CUBED) : 0., static_cast<unsigned long long>(faces.load()), lod,
+			SECONDS > 0 ? checked/SECONDS : 0.f);
+		return invalid ? 1 : 0;
+	}
+
+	//Stores chunks in a new directory in two sessions, then damages the region file the
+	//ways a crash or a failing disk would, and checks what a reopened store reads back
+	int recover(int argument_count, char **arguments)
+	{
+		std::string directory{"Recovery"};
+		for(int i{}; i+1 < argument_count; i += 2)
+			if(!std::strcmp(arguments[i], "-directory")) directory = arguments[i+1];
+		if(std::filesystem::exists(directory))
+		{
+			printf("Usage: recover [-directory <new directory>]\n%s already exists\n",
+				directory.c_str());
+			return 1;
+		}
+
+		//Each chunk's record differs by position and session, the store never parses it
+		constexpr int CHUNKS{16};
+		const auto GET_DATA = [](int x, int session)
+		{
+			std::vector<uint8_t> data(64+(x*37+session*11)%200);
+			for(size_t i{}; i < data.size(); ++i)
+				data[i] = static_cast<uint8_t>(i*31+x*7+session*101);
+			return data;
+		};
+		const auto WRITE = [&](int first, int last, int session)
+		{
+			Tetra::Region_Store store{directory, Tetra::SEED};
+			for(int x{first}; x <= last; ++x) store.write({x, 0, 0}, GET_DATA(x, session));
+		};
+
+		//Every chunk in the first session, the first half again in the second
+		WRITE(0, CHUNKS-1, 1);
+		std::filesystem::path path;
+		for(const auto& f : std::filesystem::directory_iterator{directory})
+			if(f.path().extension() == ".region") path = f.path();
+		const auto READ_FILE = [&path]
+		{
+			std::ifstream input{path, std::ios::binary};
+			return std::vector<uint8_t>{std::istreambuf_iterator<char>{input},
+				std::istreambuf_iterator<char>{}};
+		};
+		const std::vector<uint8_t> FIRST{READ_FILE()};
+		WRITE(0, CHUNKS/2-1, 2);
+		const std::vector<uint8_t> SECOND{READ_FILE()};
+		if(FIRST.empty() || SECOND.size() <= FIRST.size())
+		{
+			printf("Could not write \"%s\".\n", directory.c_str());
+			return 1;
+		}
+
+		//Replaces the file if given, then reads every chunk through a new store. Chunks
+		//that fail their checksum are expected not to be read.
+		bool passed{true};
+		const auto CHECK = [&](const char *name, const std::vector<uint8_t> *file,
+			const std::function<int(int)>& session, uint64_t recovered, uint64_t corrupt,
+			uintmax_t size)
+		{
+			if(file) std::ofstream{path, std::ios::binary|std::ios::trunc}.write(
+				reinterpret_cast<const char *>(file->data()), file->size());
+			Tetra::Region_Store store{directory, Tetra::SEED};
+			int expected{};
+			for(int x{}; x < CHUNKS; ++x)
+			{
+				const std::vector<uint8_t> DATA{GET_DATA(x, session(x))};
+				expected += store.read({x, 0, 0}, [&DATA](const uint8_t *data, size_t size)
+					{ return size == DATA.size() && !std::memcmp(data, DATA.data(), size); });
+			}
+			const Tetra::Region_Store::Statistics STATISTICS{store.get_statistics()};
+			std::error_code error;
+			const uintmax_t FILE_SIZE{std::filesystem::file_size(path, error)};
+			const bool PASSED{expected == CHUNKS-static_cast<int>(corrupt) &&
+				STATISTICS.recovered_chunks == recovered && STATISTICS.corrupt_chunks == corrupt &&
+				(!size || FILE_SIZE == size)};
+			printf("%-28s %2d of %d chunks read, %llu recovered, %llu corrupt, %llu bytes: %s\n",
+				name, expected, CHUNKS, static_cast<unsigned long long>(STATISTICS.recovered_chunks),
+				static_cast<unsigned long long>(STATISTICS.corrupt_chunks),
+				static_cast<unsigned long long>(FILE_SIZE), PASSED ? "passed" : "FAILED");
+			passed &= PASSED;
+		};
+		const auto BOTH_SESSIONS = [](int x){ return x < CHUNKS/2 ? 2 : 1; };
+		const auto FIRST_SESSION = [](int){ return 1; };
+
+		CHECK("Intact", &SECOND, BOTH_SESSIONS, 0, 0, SECOND.size());
+
+		//Cut off inside the second session's first block, its table is torn as it points
+		//past the end, so the table is rebuilt from the first session's blocks
+		std::vector<uint8_t> file{SECOND.begin(), SECOND.begin()+FIRST.size()+1};
+		CHECK("Truncated", &file, FIRST_SESSION, CHUNKS/2, 0, FIRST.size());
+
+		//Blocks appended after recovery follow the last complete one
+		WRITE(0, 0, 3);
+		CHECK("Written after truncation", nullptr, [&](int x){ return x ? 1 : 3; }, 0, 0, 0);
+
+		//Crashed before the second session's table was written
+		file.assign(FIRST.begin(), FIRST.end());
+		file.insert(file.end(), SECOND.begin()+FIRST.size(), SECOND.end());
+		CHECK("Table not written", &file, BOTH_SESSIONS, CHUNKS/2, 0, SECOND.size());
+
+		//Torn while appending a block that never finished
+		file = SECOND;
+		file.insert(file.end(), 100, 0xAB);
+		CHECK("Partial block", &file, BOTH_SESSIONS, 0, 0, SECOND.size());
+
+		//The last record of the second session is damaged on disk
+		file = SECOND;
+		file.back() ^= 0xFF;
+		CHECK("Corrupt record", &file, BOTH_SESSIONS, 0, 1, SECOND.size());
+
+		std::error_code error;
+		std::filesystem::remove_all(directory, error);
+		return passed ? 0 : 1;
+	}
+
+	//Halves an image, averaging each texel's two by two source texels, in linear space for
+	//sRGB images as the renderer filters them
+	std::vector<uint8_t> downsample(const std::vector<uint8_t>& image,
+		const glm::uvec2& resolution, bool srgb)
+	{
+		const auto TO_LINEAR = [](float c)
+		{ return c <= .04045f ? c/12.92f : std::pow((c+.055f)/1.055f, 2.4f); };
+		const auto TO_SRGB = [](float c)
+		{ return c <= .0031308f ? c*12.92f : 1.055f*std::pow(c, 1/2.4f)-.055f; };
+
+		const glm::uvec2 HALF{glm::max(resolution/2U, glm::uvec2{1})};
+		std::vector<uint8_t> half(HALF.x*HALF.y*4);
+		for(uint32_t y{}; y < HALF.y; ++y)
+			for(uint32_t x{}; x < HALF.x; ++x)
+				for(uint8_t channel{}; channel < 4; ++channel)
+				{
+					const bool CONVERT{srgb && channel < 3};
+					float sum{};
+					uint8_t samples{};
+					for(uint32_t source_y{y*2}; source_y < std::min(y*2+2, resolution.y); ++source_y)
+						for(uint32_t source_x{x*2}; source_x < std::min(x*2+2, resolution.x); ++source_x)
+						{
+							const float VALUE{image[(source_y*resolution.x+source_x)*4+channel]/255.f};
+							sum += CONVERT ? TO_LINEAR(VALUE) : VALUE, ++samples;
+						}
+					const float AVERAGE{sum/samples};
+					half[(y*HALF.x+x)*4+channel] = static_cast<uint8_t>(std::lround(
+						std::clamp(CONVERT ? TO_SRGB(AVERAGE) : AVERAGE, 0.f, 1.f)*255));
+				}
+		return half;
+	}
+
+	//Builds a texture array file from images of one resolution with every mip level,
+	//so the engine loads it without decoding images or generating mipmaps
+	int textures(int argument_count, char **arguments)
+	{
+		if(argument_count < 3 || (std::strcmp(arguments[1], "rgb") &&
+			std::strcmp(arguments[1], "linear")))
+		{
+			printf("Usage: textures <output> <rgb|linear> <images...>\n");
+			return 1;
+		}
+		namespace Texture_Array = Oreginum::Texture_Array;
+		Texture_Array::Header header{};
+		header.magic = Texture_Array::MAGIC, header.version = Texture_Array::VERSION;
+		header.format = std::strcmp(arguments[1], "linear") ? Texture_Array::RGB :
+			Texture_Array::LINEAR;
+
+		//Decode every layer
+		std::vector<std::vector<uint8_t>> layers;
+		glm::ivec2 resolution{0};
+		for(int i{2}; i < argument_count; ++i)
+		{
+			glm::ivec2 image_resolution;
+			uint8_t *image{stbi_load(arguments[i], &image_resolution.x,
+				&image_resolution.y, nullptr, STBI_rgb_alpha)};
+			if(!image){ printf("Could not load image \"%s\".\n", arguments[i]); return 1; }
+			if(layers.empty()) resolution = image_resolution;
+			layers.emplace_back(image, image+image_resolution.x*image_resolution.y*4);
+			stbi_image_free(image);
+			if(image_resolution != resolution)
+			{
+				printf("\"%s\" is a different resolution to the first image.\n", arguments[i]);
+				return 1;
+			}
+		}
+		header.width = resolution.x, header.height = resolution.y;
+		header.layers = static_cast<uint32_t>(layers.size());
+		while(header.levels < Texture_Array::MAXIMUM_LEVELS &&
+			std::max(header.width, header.height)>>header.levels) ++header.levels;
+
+		//Each level holds every layer, then every layer is halved for the next
+		std::vector<uint8_t> data(sizeof(Texture_Array::Header));
+		for(uint32_t level{}; level < header.levels; ++level)
+		{
+			header.level_offsets[level] = static_cast<uint32_t>(data.size());
+			const glm::uvec2 LEVEL_RESOLUTION{glm::max(glm::uvec2(resolution)>>level, glm::uvec2{1})};
+			for(std::vector<uint8_t>& l : layers)
+			{
+				data.insert(data.end(), l.begin(), l.end());
+				l = downsample(l, LEVEL_RESOLUTION, header.format == Texture_Array::LINEAR);
+			}
+		}
+		std::memcpy(data.data(), &header, sizeof(header));
+
+		std::ofstream output{arguments[0], std::ios::binary|std::ios::trunc};
+		output.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if(!output){ printf("Could not write \"%s\".\n", arguments[0]); return 1; }
+		printf("%s: %u layers of %ux%u, %u levels, %zu bytes\n", arguments[0],
+			header.layers, header.width, header.height, header.levels, data.size());
+		return 0;
+	}
+
+	//Packs the files under a directory, those with the given extensions if any, into a
+	//resource pack named by their paths under it
+	int pack(int argument_count, char **arguments)
+	{
+		if(argument_count < 2)
+		{
+			printf("Usage: pack <output> <directory> [extensions...]\n");
+			return 1;
+		}
+		namespace Resource_Pack = Oreginum::Resource_Pack;
+		const std::filesystem::path DIRECTORY{arguments[1]};
+		std::error_code error;
+		const std::filesystem::path OUTPUT{std::filesystem::absolute(arguments[0], error)};
+
+		//Sorted so the same files always make the same pack
+		std::vector<std::pair<std::string, std::filesystem::path>> files;
+		for(const auto& f : std::filesystem::recursive_directory_iterator{DIRECTORY, error})
+		{
+			if(!f.is_regular_file() || std::filesystem::absolute(f.path(), error) == OUTPUT)
+				continue;
+			bool included{argument_count == 2};
+			for(int i{2}; i < argument_count; ++i)
+				included |= f.path().extension() == arguments[i];
+			if(included) files.emplace_back(
+				std::filesystem::relative(f.path(), DIRECTORY).generic_string(), f.path());
+		}
+		if(error){ printf("Could not read \"%s\".\n", arguments[1]); return 1; }
+		std::sort(files.begin(), files.end());
+
+		Resource_Pack::Header header{};
+		header.magic = Resource_Pack::MAGIC, header.version = Resource_Pack::VERSION;
+		header.entries = static_cast<uint32_t>(files.size());
+		std::vector<Resource_Pack::Entry> entries;
+		std::string names;
+		for(const auto& f : files)
+		{
+			entries.push_back({0, 0, static_cast<uint32_t>(names.size()),
+				static_cast<uint32_t>(f.first.size())});
+			names += f.first;
+		}
+		header.names_size = static_cast<uint32_t>(names.size());
+
+		std::vector<uint8_t> data(sizeof(header)+entries.size()*sizeof(Resource_Pack::Entry));
+		data.insert(data.end(), names.begin(), names.end());
+		for(size_t i{}; i < files.size(); ++i)
+		{
+			std::ifstream input{files[i].second, std::ios::binary};
+			const std::vector<uint8_t> FILE{std::istreambuf_iterator<char>{input},
+				std::istreambuf_iterator<char>{}};
+			if(!input && !input.eof())
+			{
+				printf("Could not read \"%s\".\n", files[i].second.string().c_str());
+				return 1;
+			}
+			data.resize((data.size()+Resource_Pack::ALIGNMENT-1)/
+				Resource_Pack::ALIGNMENT*Resource_Pack::ALIGNMENT);
+			entries[i].offset = data.size(), entries[i].size = FILE.size();
+			data.insert(data.end(), FILE.begin(), FILE.end());
+		}
+		std::memcpy(data.data(), &header, sizeof(header));
+		std::memcpy(data.data()+sizeof(header), entries.data(),
+			entries.size()*sizeof(Resource_Pack::Entry));
+
+		std::ofstream output{arguments[0], std::ios::binary|std::ios::trunc};
+		output.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if(!output){ printf("Could not write \"%s\".\n", arguments[0]); return 1; }
+		for(const auto& f : files) printf("  %s\n", f.first.c_str());
+		printf("%s: %zu files, %zu bytes\n", arguments[0], files.size(), data.size());
+		return 0;
+	}
+}
+
+int main(int argument_count, char **arguments)
+{
+	//Each subcommand is given the arguments after its name
+	if(argument_count > 1 && !std::strcmp(arguments[1], "pregen"))
+		return pregen(argument_count-2, arguments+2);
+	if(argument_count > 1 && !std::strcmp(arguments[1], "verify"))
+		return verify(argument_count-2, arguments+2);
+	if(argument_count > 1 && !std::strcmp(arguments[1], "recover"))
+		return recover(argument_count-2, arguments+2);
+	if(argument_count > 1 && !std::strcmp(arguments[1], "textures"))
+		return textures(argument_count-2, arguments+2);
+	if(argument_count > 1 && !std::strcmp(arguments[1], "pack"))
+		return pack(argument_count-2, arguments+2);
+	printf("Usage: voxceleron2-tools <command> [arguments]\nCommands:\n"
+		"  pregen    Generate and store the chunks in a box of chunk coordinates\n"
+		"  verify    Check the stored chunks in a box of chunk coordinates\n"
+		"  recover   Check that damaged region files are recovered\n"
+		"  textures  Build a texture array with its mipmaps from images\n"
+		"  pack      Pack the files in a directory into a resource pack\n");
+	return 1;
+}
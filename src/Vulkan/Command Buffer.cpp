@@ -27,9 +27,12 @@ void Oreginum::Vulkan::Command_Buffer::swap(Command_Buffer *other)
 	std::swap(fence, other->fence);
 }
 
+void Oreginum::Vulkan::Command_Buffer::wait() const
+{ device->get().waitForFences({fence.get()}, VK_TRUE, std::numeric_limits<uint64_t>::max()); }
+
 void Oreginum::Vulkan::Command_Buffer::begin(vk::CommandBufferUsageFlagBits flags) const
 {
-    device->get().waitForFences({fence.get()}, VK_TRUE, std::numeric_limits<uint64_t>::max());
+	wait();
 	vk::CommandBufferBeginInfo command_buffer_begin_information{flags};
 	command_buffer->begin(command_buffer_begin_information);
 }
@@ -23,6 +23,7 @@ namespace Oreginum::Vulkan
 		void end() const;
 		void submit() const;
 		void end_and_submit() const { end(), submit(); }
+		void wait() const;
 
 		const vk::CommandBuffer& get() const { return *command_buffer; }
 
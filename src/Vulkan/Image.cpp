@@ -157,6 +157,71 @@ Oreginum::Vulkan::Image::Image(std::shared_ptr<Device> device, const Sampler& sa
 	descriptor_information = {sampler.get(), *image_view, vk::ImageLayout::eShaderReadOnlyOptimal};
 }
 
+Oreginum::Vulkan::Image::Image(std::shared_ptr<Device> device, const Sampler& sampler,
+	const Command_Buffer& temporary_command_buffer, const glm::uvec2& resolution,
+	uint32_t layers, const void *data, size_t size, const std::vector<size_t>& level_offsets,
+	vk::Format format) : device(device), resolution(resolution),
+	aspect(vk::ImageAspectFlagBits::eColor)
+{
+	mip_levels = static_cast<uint8_t>(level_offsets.size());
+
+	//Create stage buffer and copy every level into it at once
+	vk::Buffer stage;
+	vk::BufferCreateInfo stage_information{{}, size, vk::BufferUsageFlagBits::eTransferSrc};
+	if(device->get().createBuffer(&stage_information, nullptr, &stage) != vk::Result::eSuccess)
+		Core::error("Could not create a Vulkan image stage buffer.");
+	vk::MemoryRequirements memory_requirements(device->get().getBufferMemoryRequirements(stage));
+	vk::MemoryAllocateInfo memory_information{memory_requirements.size,
+		Buffer::find_memory(*device, memory_requirements.memoryTypeBits,
+		vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent)};
+	vk::DeviceMemory stage_memory;
+	if(device->get().allocateMemory(&memory_information, nullptr, &stage_memory) !=
+		vk::Result::eSuccess) Core::error("Could not allocate Vulkan image stage memory.");
+	device->get().bindBufferMemory(stage, stage_memory, 0);
+	auto result{device->get().mapMemory(stage_memory, 0, size)};
+	if(result.result != vk::Result::eSuccess)
+		Core::error("Could not map Vulkan image stage memory.");
+	std::memcpy(result.value, data, size);
+	device->get().unmapMemory(stage_memory);
+
+	//Create image
+	image = create_image(*device, {resolution.x, resolution.y}, mip_levels,
+		vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, format,
+		aspect, layers, vk::ImageTiling::eOptimal, layers > 1);
+	image_memory = create_and_bind_image_memory(*device, image);
+
+	//Copy every level of every layer, between the two transitions, in one submission
+	std::vector<vk::BufferImageCopy> regions;
+	for(uint32_t i{}; i < mip_levels; ++i)
+		regions.push_back({level_offsets[i], 0, 0, {aspect, i, 0, layers}, {},
+			{std::max(resolution.x>>i, 1U), std::max(resolution.y>>i, 1U), 1}});
+	temporary_command_buffer.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+	transition(temporary_command_buffer, image, aspect,
+		vk::ImageLayout::ePreinitialized, vk::ImageLayout::eTransferDstOptimal,
+		{}, vk::AccessFlagBits::eTransferWrite,
+		vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+		0, layers, 0, mip_levels, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, false);
+	temporary_command_buffer.get().copyBufferToImage(stage, image,
+		vk::ImageLayout::eTransferDstOptimal, regions);
+	transition(temporary_command_buffer, image, aspect,
+		vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal,
+		vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead,
+		vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+		0, layers, 0, mip_levels, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, false);
+	temporary_command_buffer.end_and_submit();
+
+	//Create image view
+	create_image_view(format, aspect, layers, mip_levels,
+		layers > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D);
+
+	//Deallocate stage device memory once the copy is done
+	temporary_command_buffer.wait();
+	device->get().destroyBuffer(stage);
+	device->get().freeMemory(stage_memory);
+
+	descriptor_information = {sampler.get(), *image_view, vk::ImageLayout::eShaderReadOnlyOptimal};
+}
+
 Oreginum::Vulkan::Image::Image(std::shared_ptr<Device> device, const Sampler& sampler,
 	const glm::uvec2& resolution, vk::ImageUsageFlags usage, vk::Format format,
 	vk::ImageAspectFlags aspect, vk::SampleCountFlagBits samples)
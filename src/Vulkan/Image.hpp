@@ -29,6 +29,12 @@ namespace Oreginum::Vulkan
 			const Command_Buffer& temporary_command_buffer,
 			const glm::uvec2& resolution, const std::vector<void *>& datas,
 			vk::Format format, bool cubemap);
+		//An image array with every mip level supplied, each level's layers in order from its
+		//offset in data, copied from one staging buffer in a single submission
+		Image(std::shared_ptr<Device> device, const Sampler& sampler,
+			const Command_Buffer& temporary_command_buffer, const glm::uvec2& resolution,
+			uint32_t layers, const void *data, size_t size,
+			const std::vector<size_t>& level_offsets, vk::Format format);
 		Image(std::shared_ptr<Device> device, vk::Image image, vk::Format format = SWAPCHAIN_FORMAT,
 			vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor)
 			: device(device), image(image), aspect(aspect), swapchain(true)
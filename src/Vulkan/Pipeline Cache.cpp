@@ -0,0 +1,66 @@
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include "../Oreginum/Core.hpp"
+#include "Pipeline Cache.hpp"
+
+Oreginum::Vulkan::Pipeline_Cache::Pipeline_Cache(std::shared_ptr<Device> device,
+	const std::string& path) : device(device), path(path)
+{
+	std::vector<char> data;
+	std::ifstream file{path, std::ios::ate | std::ios::binary};
+	if(file.is_open())
+	{
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(data.data(), data.size());
+		if(!file) data.clear();
+	}
+
+	//The header holds its length, version, vendor, device and cache UUID
+	const vk::PhysicalDeviceProperties& PROPERTIES{device->get_properties()};
+	uint32_t header[4];
+	if(data.size() < sizeof(header)+VK_UUID_SIZE) data.clear();
+	else
+	{
+		std::memcpy(header, data.data(), sizeof(header));
+		if(header[1] != static_cast<uint32_t>(vk::PipelineCacheHeaderVersion::eOne) ||
+			header[2] != PROPERTIES.vendorID || header[3] != PROPERTIES.deviceID ||
+			std::memcmp(data.data()+sizeof(header), PROPERTIES.pipelineCacheUUID,
+			VK_UUID_SIZE)) data.clear();
+	}
+
+	vk::PipelineCacheCreateInfo pipeline_cache_information{{}, data.size(), data.data()};
+	if(device->get().createPipelineCache(&pipeline_cache_information, nullptr,
+		pipeline_cache.get()) != vk::Result::eSuccess)
+		Core::error("Could not create a Vulkan pipeline cache.");
+}
+
+Oreginum::Vulkan::Pipeline_Cache::~Pipeline_Cache()
+{
+	if(pipeline_cache.use_count() != 1 || !*pipeline_cache || !device) return;
+	device->get().destroyPipelineCache(*pipeline_cache);
+}
+
+void Oreginum::Vulkan::Pipeline_Cache::save() const
+{
+	auto data{device->get().getPipelineCacheData(*pipeline_cache)};
+	if(data.result != vk::Result::eSuccess || data.value.empty()) return;
+
+	//Written beside the old cache and moved over it, so a cut off write is never loaded
+	const std::string TEMPORARY{path+".tmp"};
+	{
+		std::ofstream file{TEMPORARY, std::ios::binary | std::ios::trunc};
+		file.write(reinterpret_cast<const char *>(data.value.data()), data.value.size());
+		if(!file) return;
+	}
+	std::remove(path.c_str());
+	std::rename(TEMPORARY.c_str(), path.c_str());
+}
+
+void Oreginum::Vulkan::Pipeline_Cache::swap(Pipeline_Cache *other)
+{
+	std::swap(device, other->device);
+	std::swap(path, other->path);
+	std::swap(pipeline_cache, other->pipeline_cache);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include "Device.hpp"
+
+namespace Oreginum::Vulkan
+{
+	//A pipeline cache kept in a file between runs, data saved by another driver or GPU
+	//is ignored and the cache starts empty
+	class Pipeline_Cache
+	{
+	public:
+		Pipeline_Cache(){}
+		Pipeline_Cache(std::shared_ptr<Device> device, const std::string& path);
+		Pipeline_Cache *operator=(Pipeline_Cache other){ swap(&other); return this; }
+		~Pipeline_Cache();
+
+		void save() const;
+
+		const vk::PipelineCache& get() const { return *pipeline_cache; }
+
+	private:
+		std::shared_ptr<Device> device;
+		std::string path;
+		std::shared_ptr<vk::PipelineCache> pipeline_cache = std::make_shared<vk::PipelineCache>();
+
+		void swap(Pipeline_Cache *other);
+	};
+}
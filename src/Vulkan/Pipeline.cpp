@@ -2,8 +2,8 @@
 #include "../Oreginum//Core.hpp"
 #include "Pipeline.hpp"
 
-Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device, const glm::uvec2& resolution,
-	const Render_Pass& render_pass, const Shader& shader,
+Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device,
+	const Pipeline_Cache& pipeline_cache, const Render_Pass& render_pass, const Shader& shader,
 	std::vector<vk::DescriptorSetLayout> descriptor_set_layouts, 
 	uint8_t render_pass_number, const Pipeline& base)
 	: device(device), descriptor_set_layouts(descriptor_set_layouts)
@@ -16,10 +16,10 @@ Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device, const glm::
 	{
 		binding_descriptions.resize(1);
 		binding_descriptions[0].setBinding(0);
-		binding_descriptions[0].setStride(sizeof(float)*9);
+		binding_descriptions[0].setStride(sizeof(float)*10);
 		binding_descriptions[0].setInputRate(vk::VertexInputRate::eVertex);
 
-		attribute_descriptions.resize(4);
+		attribute_descriptions.resize(5);
 
 		//Vertex
 		attribute_descriptions[0].setBinding(0);
@@ -44,13 +44,19 @@ Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device, const glm::
 		attribute_descriptions[3].setLocation(3);
 		attribute_descriptions[3].setFormat(vk::Format::eR32Sfloat);
 		attribute_descriptions[3].setOffset(sizeof(float)*8);
+
+		//Ambient occlusion
+		attribute_descriptions[4].setBinding(0);
+		attribute_descriptions[4].setLocation(4);
+		attribute_descriptions[4].setFormat(vk::Format::eR32Sfloat);
+		attribute_descriptions[4].setOffset(sizeof(float)*9);
 	}
 
 	if(render_pass_number == 1 || render_pass_number == 2)
 	{
 		binding_descriptions.resize(1);
 		binding_descriptions[0].setBinding(0);
-		binding_descriptions[0].setStride(sizeof(float)*9);
+		binding_descriptions[0].setStride(sizeof(float)*10);
 		binding_descriptions[0].setInputRate(vk::VertexInputRate::eVertex);
 
 		attribute_descriptions.resize(1);
@@ -75,24 +81,16 @@ Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device, const glm::
 	input_assembly_state_information.setTopology(vk::PrimitiveTopology::eTriangleList);
 	input_assembly_state_information.setPrimitiveRestartEnable(VK_FALSE);
 
-	//Viewport
-	vk::Viewport viewport;
-	viewport.setX(0);
-	viewport.setY(0);
-	viewport.setWidth(static_cast<float>(resolution.x));
-	viewport.setHeight(static_cast<float>(resolution.y));
-	viewport.setMinDepth(0.f);
-	viewport.setMaxDepth(1.f);
-
-	vk::Rect2D scissor;
-	scissor.setOffset({0, 0});
-	scissor.setExtent(vk::Extent2D{resolution.x, resolution.y});
-
+	//Viewport, set when recording
 	vk::PipelineViewportStateCreateInfo viewport_state_information;
 	viewport_state_information.setViewportCount(1);
-	viewport_state_information.setPViewports(&viewport);
 	viewport_state_information.setScissorCount(1);
-	viewport_state_information.setPScissors(&scissor);
+
+	std::array<vk::DynamicState, 2> dynamic_states{vk::DynamicState::eViewport,
+		vk::DynamicState::eScissor};
+	vk::PipelineDynamicStateCreateInfo dynamic_state_information;
+	dynamic_state_information.setDynamicStateCount(static_cast<uint32_t>(dynamic_states.size()));
+	dynamic_state_information.setPDynamicStates(dynamic_states.data());
 
 	//Rasterization
 	vk::PipelineRasterizationStateCreateInfo rasterization_state_information;
@@ -177,14 +175,14 @@ Oreginum::Vulkan::Pipeline::Pipeline(std::shared_ptr<Device> device, const glm::
 	pipeline_information.setPMultisampleState(&multisample_state_information);
 	pipeline_information.setPDepthStencilState(&depth_stencil_information);
 	pipeline_information.setPColorBlendState(&color_blend_state_information);
-	pipeline_information.setPDynamicState(nullptr);
+	pipeline_information.setPDynamicState(&dynamic_state_information);
 	pipeline_information.setLayout(pipeline_layout);
 	pipeline_information.setRenderPass(render_pass.get());
 	pipeline_information.setSubpass(0);
 	pipeline_information.setBasePipelineHandle(base.get());
 	pipeline_information.setBasePipelineIndex(-1);
 
-	if(device->get().createGraphicsPipelines(nullptr, 1,
+	if(device->get().createGraphicsPipelines(pipeline_cache.get(), 1,
 		&pipeline_information, nullptr, pipeline.get()) != vk::Result::eSuccess)
 		Oreginum::Core::error("Could not create a Vulkan graphics pipeline.");
 }
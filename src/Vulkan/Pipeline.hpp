@@ -8,6 +8,7 @@
 #include "Descriptor Set.hpp"
 #include "Render Pass.hpp"
 #include "Swapchain.hpp"
+#include "Pipeline Cache.hpp"
 
 namespace Oreginum::Vulkan
 {
@@ -15,7 +16,8 @@ namespace Oreginum::Vulkan
 	{
 	public:
 		Pipeline(){}
-		Pipeline(std::shared_ptr<Device> device, const glm::uvec2& resolution,
+		//Viewport and scissor are dynamic, so a pipeline is used at any resolution
+		Pipeline(std::shared_ptr<Device> device, const Pipeline_Cache& pipeline_cache,
 			const Render_Pass& render_pass, const Shader& shader,
 			std::vector<vk::DescriptorSetLayout> descriptor_set_layouts,
 			uint8_t render_pass_number, const Pipeline& base = {});
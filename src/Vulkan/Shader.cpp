@@ -1,5 +1,6 @@
 #include <fstream>
 #include "../Oreginum/Core.hpp"
+#include "../Oreginum/Resource Pack.hpp"
 #include "Shader.hpp"
 
 Oreginum::Vulkan::Shader::Shader(std::shared_ptr<Device> device, const std::vector<
@@ -27,17 +28,24 @@ void Oreginum::Vulkan::Shader::swap(Shader *other)
 
 vk::ShaderModule Oreginum::Vulkan::Shader::create_shader_module(const std::string& shader)
 {
-	std::ifstream file{"Resources/Shaders/"+shader+".spv", std::ios::ate | std::ios::binary};
-	if(!file.is_open()) Oreginum::Core::error("Could not open shader \""+shader+"\".");
-	size_t size{static_cast<size_t>(file.tellg())};
-	file.seekg(0);
-	std::vector<char> data(size);
-	file.read(data.data(), size);
-	file.close();
+	//Packed shaders are used in place, loose ones are read into memory
+	Resource_Pack::Span code{Resource_Pack::get("Shaders/"+shader+".spv")};
+	std::vector<uint32_t> data;
+	if(!code.data)
+	{
+		std::ifstream file{"Resources/Shaders/"+shader+".spv", std::ios::ate | std::ios::binary};
+		if(!file.is_open()) Oreginum::Core::error("Could not open shader \""+shader+"\".");
+		size_t size{static_cast<size_t>(file.tellg())};
+		file.seekg(0);
+		data.resize((size+3)/4);
+		file.read(reinterpret_cast<char *>(data.data()), size);
+		file.close();
+		code = {reinterpret_cast<const uint8_t *>(data.data()), size};
+	}
 
 	vk::ShaderModuleCreateInfo shader_module_information;
-	shader_module_information.setCodeSize(data.size());
-	shader_module_information.setPCode(reinterpret_cast<const uint32_t *>(data.data()));
+	shader_module_information.setCodeSize(code.size);
+	shader_module_information.setPCode(reinterpret_cast<const uint32_t *>(code.data));
 
 	vk::ShaderModule shader_module;
 	if(device->get().createShaderModule(&shader_module_information,